@@ -48,7 +48,120 @@ MARK_AS_ADVANCED(
     CMAKE_EXE_LINKER_FLAGS_RELWITHDEBINFOGG
     CMAKE_SHARED_LINKER_FLAGS_RELWITHDEBINFOGG )
 
+# Production - size-optimized release for deployment
+#
+# full LTO and the unused functions and data are stripped by the linker - the ImGui demo windows are excluded
+# (see third-party/imgui/CMakeLists.txt) and a size report is printed after each build (see SizeReport.cmake)
+# on the web, -Oz at link time also runs wasm-opt
+
+if (EMSCRIPTEN OR CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    set(GGWEB_SIZE_OPT "-Oz")
+else()
+    set(GGWEB_SIZE_OPT "-Os")
+endif()
+
+if (EMSCRIPTEN)
+    set(GGWEB_SIZE_LINK "${GGWEB_SIZE_OPT} -flto")
+elseif (APPLE)
+    set(GGWEB_SIZE_LINK "${GGWEB_SIZE_OPT} -flto -Wl,-dead_strip")
+else()
+    set(GGWEB_SIZE_LINK "${GGWEB_SIZE_OPT} -flto -Wl,--gc-sections -s")
+endif()
+
+SET(CMAKE_CXX_FLAGS_PRODUCTION
+    "${GGWEB_SIZE_OPT} -DNDEBUG -flto -ffunction-sections -fdata-sections"
+    CACHE STRING "Flags used by the c++ compiler during size-optimized production builds."
+    FORCE )
+SET(CMAKE_C_FLAGS_PRODUCTION
+    "${GGWEB_SIZE_OPT} -DNDEBUG -flto -ffunction-sections -fdata-sections"
+    CACHE STRING "Flags used by the compiler during size-optimized production builds."
+    FORCE )
+SET(CMAKE_EXE_LINKER_FLAGS_PRODUCTION
+    "${GGWEB_SIZE_LINK}"
+    CACHE STRING "Flags used for linking binaries during size-optimized production builds."
+    FORCE )
+SET(CMAKE_SHARED_LINKER_FLAGS_PRODUCTION
+    "${GGWEB_SIZE_LINK}"
+    CACHE STRING "Flags used by the shared libraries linker during size-optimized production builds."
+    FORCE )
+MARK_AS_ADVANCED(
+    CMAKE_CXX_FLAGS_PRODUCTION
+    CMAKE_C_FLAGS_PRODUCTION
+    CMAKE_EXE_LINKER_FLAGS_PRODUCTION
+    CMAKE_SHARED_LINKER_FLAGS_PRODUCTION )
+
+# the static libraries contain LTO bitcode - use the archiver wrappers that load the LTO plugin
+if (CMAKE_BUILD_TYPE STREQUAL "Production" AND CMAKE_COMPILER_IS_GNUCC AND CMAKE_CXX_COMPILER_AR AND CMAKE_CXX_COMPILER_RANLIB)
+    set(CMAKE_AR     ${CMAKE_CXX_COMPILER_AR})
+    set(CMAKE_RANLIB ${CMAKE_CXX_COMPILER_RANLIB})
+endif()
+
+# PGOGenerate / PGOUse - profile-guided optimization, native only
+#
+# 1. configure with -DCMAKE_BUILD_TYPE=PGOGenerate, build and run "make pgo-train" - the instrumented ggweb-bench
+#    runs the scripted UI workloads without a window and the profile is written to GGWEB_PGO_DIR
+# 2. reconfigure the same build folder with -DCMAKE_BUILD_TYPE=PGOUse and build
+#
+# the code that the benchmark does not run (the SDL platform layer) is optimized as usual
+
+set(GGWEB_PGO_DIR "${CMAKE_BINARY_DIR}/pgo" CACHE PATH "Folder for the profiles of the PGOGenerate and PGOUse build types")
+
+# the benchmark runs the UI on the thread pool as well
+set(GGWEB_PGO_GENERATE "-O3 -DNDEBUG -fprofile-generate=${GGWEB_PGO_DIR} -fprofile-update=atomic")
+
+if (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    set(GGWEB_PGO_USE "-O3 -DNDEBUG -fprofile-use=${GGWEB_PGO_DIR}/default.profdata -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date")
+else()
+    set(GGWEB_PGO_USE "-O3 -DNDEBUG -fprofile-use=${GGWEB_PGO_DIR} -fprofile-partial-training -fprofile-correction -Wno-missing-profile")
+endif()
+
+SET(CMAKE_CXX_FLAGS_PGOGENERATE
+    "${GGWEB_PGO_GENERATE}"
+    CACHE STRING "Flags used by the c++ compiler during instrumented builds for profile-guided optimization."
+    FORCE )
+SET(CMAKE_C_FLAGS_PGOGENERATE
+    "${GGWEB_PGO_GENERATE}"
+    CACHE STRING "Flags used by the compiler during instrumented builds for profile-guided optimization."
+    FORCE )
+SET(CMAKE_EXE_LINKER_FLAGS_PGOGENERATE
+    "-fprofile-generate=${GGWEB_PGO_DIR}"
+    CACHE STRING "Flags used for linking binaries during instrumented builds for profile-guided optimization."
+    FORCE )
+SET(CMAKE_SHARED_LINKER_FLAGS_PGOGENERATE
+    "-fprofile-generate=${GGWEB_PGO_DIR}"
+    CACHE STRING "Flags used by the shared libraries linker during instrumented builds for profile-guided optimization."
+    FORCE )
+SET(CMAKE_CXX_FLAGS_PGOUSE
+    "${GGWEB_PGO_USE}"
+    CACHE STRING "Flags used by the c++ compiler during profile-guided optimized builds."
+    FORCE )
+SET(CMAKE_C_FLAGS_PGOUSE
+    "${GGWEB_PGO_USE}"
+    CACHE STRING "Flags used by the compiler during profile-guided optimized builds."
+    FORCE )
+SET(CMAKE_EXE_LINKER_FLAGS_PGOUSE
+    ""
+    CACHE STRING "Flags used for linking binaries during profile-guided optimized builds."
+    FORCE )
+SET(CMAKE_SHARED_LINKER_FLAGS_PGOUSE
+    ""
+    CACHE STRING "Flags used by the shared libraries linker during profile-guided optimized builds."
+    FORCE )
+MARK_AS_ADVANCED(
+    CMAKE_CXX_FLAGS_PGOGENERATE
+    CMAKE_C_FLAGS_PGOGENERATE
+    CMAKE_EXE_LINKER_FLAGS_PGOGENERATE
+    CMAKE_SHARED_LINKER_FLAGS_PGOGENERATE
+    CMAKE_CXX_FLAGS_PGOUSE
+    CMAKE_C_FLAGS_PGOUSE
+    CMAKE_EXE_LINKER_FLAGS_PGOUSE
+    CMAKE_SHARED_LINKER_FLAGS_PGOUSE )
+
+if (EMSCRIPTEN AND CMAKE_BUILD_TYPE MATCHES "^PGO")
+    message(FATAL_ERROR "The ${CMAKE_BUILD_TYPE} build type is not supported on the web")
+endif()
+
 if (NOT XCODE AND NOT MSVC AND NOT CMAKE_BUILD_TYPE)
     set(CMAKE_BUILD_TYPE Release CACHE STRING "Build type" FORCE)
-    set_property(CACHE CMAKE_BUILD_TYPE PROPERTY STRINGS "Debug" "Release" "MinSizeRel" "RelWithDebInfo" "ReleaseGG" "RelWithDebInfoGG")
+    set_property(CACHE CMAKE_BUILD_TYPE PROPERTY STRINGS "Debug" "Release" "MinSizeRel" "RelWithDebInfo" "ReleaseGG" "RelWithDebInfoGG" "Production" "PGOGenerate" "PGOUse")
 endif()
@@ -0,0 +1,80 @@
+# Content-hashed file names for the production web build
+#
+# Run as a post-build step with cmake -P. Copies the build outputs into the public folder with the hash of their
+# contents in the name (ggweb-app.js -> ggweb-app.0123456789abcdef.js), so they can be cached forever, and writes
+# index.html with the hashed names. Only index.html has to be revalidated on each visit.
+#
+# Variables:
+#   TARGET       - name of the app target
+#   BIN_DIR      - folder with the .js, .wasm and .data files produced by Emscripten
+#   EXTRA_DIR    - folder with index.html, style.css, helpers.js and the fonts, as configured at configure time
+#   PUBLIC_DIR   - output folder
+
+foreach(VAR TARGET BIN_DIR EXTRA_DIR PUBLIC_DIR)
+    if (NOT DEFINED ${VAR})
+        message(FATAL_ERROR "HashWebAssets: ${VAR} is not set")
+    endif()
+endforeach()
+
+# remove the files of the previous builds
+file(GLOB OLD_FILES
+    "${PUBLIC_DIR}/${TARGET}.*.js"
+    "${PUBLIC_DIR}/${TARGET}.*.wasm"
+    "${PUBLIC_DIR}/${TARGET}.*.data"
+    "${PUBLIC_DIR}/style.*.css"
+    "${PUBLIC_DIR}/helpers.*.js"
+    "${PUBLIC_DIR}/*.*.ttf"
+    )
+if (OLD_FILES)
+    file(REMOVE ${OLD_FILES})
+endif()
+
+# copy SRC into the public folder with the hash in the name - the new name is returned in OUT
+function(hash_asset SRC OUT)
+    get_filename_component(NAME ${SRC} NAME)
+    string(FIND ${NAME} "." DOT)
+    string(SUBSTRING ${NAME} 0 ${DOT} BASE)
+    string(SUBSTRING ${NAME} ${DOT} -1 EXT)
+
+    file(SHA256 ${SRC} HASH)
+    string(SUBSTRING ${HASH} 0 16 HASH)
+
+    set(HASHED "${BASE}.${HASH}${EXT}")
+    configure_file(${SRC} ${PUBLIC_DIR}/${HASHED} COPYONLY)
+
+    set(${OUT} ${HASHED} PARENT_SCOPE)
+endfunction()
+
+# the files that are loaded by the Emscripten runtime - mapped through Module.locateFile()
+set(ASSET_FILES "")
+foreach(EXT js wasm data worker.js)
+    set(SRC "${BIN_DIR}/${TARGET}.${EXT}")
+    if (EXISTS ${SRC})
+        hash_asset(${SRC} HASHED)
+        if (ASSET_FILES)
+            set(ASSET_FILES "${ASSET_FILES}, ")
+        endif()
+        set(ASSET_FILES "${ASSET_FILES}\"${TARGET}.${EXT}\": \"${HASHED}\"")
+    elseif (EXT STREQUAL "js" OR EXT STREQUAL "wasm")
+        message(FATAL_ERROR "HashWebAssets: ${SRC} does not exist - the production build needs a separate .wasm")
+    endif()
+endforeach()
+
+# the fonts are fetched by the app - see assets.h
+file(GLOB FONT_FILES "${EXTRA_DIR}/*.ttf")
+foreach(SRC ${FONT_FILES})
+    get_filename_component(NAME ${SRC} NAME)
+    hash_asset(${SRC} HASHED)
+    set(ASSET_FILES "${ASSET_FILES}, \"${NAME}\": \"${HASHED}\"")
+endforeach()
+
+hash_asset(${EXTRA_DIR}/style.css   STYLE_CSS)
+hash_asset(${EXTRA_DIR}/helpers.js  HELPERS_JS)
+
+file(READ ${EXTRA_DIR}/index.html HTML)
+string(REPLACE "@GGWEB_ASSET_FILES@" "{ ${ASSET_FILES} }" HTML "${HTML}")
+string(REPLACE "@GGWEB_STYLE_CSS@"   "${STYLE_CSS}"       HTML "${HTML}")
+string(REPLACE "@GGWEB_HELPERS_JS@"  "${HELPERS_JS}"      HTML "${HTML}")
+file(WRITE ${PUBLIC_DIR}/index.html "${HTML}")
+
+message(STATUS "HashWebAssets: ${ASSET_FILES}, ${STYLE_CSS}, ${HELPERS_JS}")
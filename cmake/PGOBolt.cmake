@@ -0,0 +1,43 @@
+# Post-link layout optimization with BOLT
+#
+# Run by the pgo-bolt target of PGOUse builds with GGWEB_PGO_BOLT. The app is instrumented by BOLT and run headless
+# (it needs a display for the hidden window), then the hot code is reordered using the collected profile. The
+# optimized binary is written next to the app as ggweb-app-bolt.
+#
+# Variables:
+#   APP        - ggweb-app, linked with --emit-relocs
+#   PGO_DIR    - profile folder
+#   LLVM_BOLT  - llvm-bolt
+
+foreach(VAR APP PGO_DIR LLVM_BOLT)
+    if (NOT DEFINED ${VAR})
+        message(FATAL_ERROR "PGOBolt: ${VAR} is not set")
+    endif()
+endforeach()
+
+set(APP_INSTR ${PGO_DIR}/ggweb-app-instr)
+set(FDATA     ${PGO_DIR}/ggweb-app.fdata)
+
+file(MAKE_DIRECTORY ${PGO_DIR})
+file(REMOVE ${FDATA})
+
+execute_process(COMMAND ${LLVM_BOLT} ${APP} -instrument -instrumentation-file=${FDATA} -o ${APP_INSTR} RESULT_VARIABLE RES)
+if (NOT RES EQUAL 0)
+    message(FATAL_ERROR "PGOBolt: failed to instrument ${APP}: ${RES}")
+endif()
+
+# the same workload as "ggweb-app --headless" - the full render loop without vsync
+get_filename_component(APP_DIR ${APP} DIRECTORY)
+execute_process(COMMAND ${APP_INSTR} --headless 1000 WORKING_DIRECTORY ${APP_DIR} RESULT_VARIABLE RES)
+if (NOT RES EQUAL 0 OR NOT EXISTS ${FDATA})
+    message(FATAL_ERROR "PGOBolt: the training run failed: ${RES}")
+endif()
+
+execute_process(COMMAND ${LLVM_BOLT} ${APP} -data=${FDATA} -o ${APP}-bolt
+    -reorder-blocks=ext-tsp -reorder-functions=hfsort -split-functions -split-all-cold -dyno-stats
+    RESULT_VARIABLE RES)
+if (NOT RES EQUAL 0)
+    message(FATAL_ERROR "PGOBolt: failed to optimize ${APP}: ${RES}")
+endif()
+
+message(STATUS "PGOBolt: the optimized app is ${APP}-bolt")
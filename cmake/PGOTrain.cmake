@@ -0,0 +1,39 @@
+# Training run for profile-guided optimization
+#
+# Run by the pgo-train target of PGOGenerate builds. Runs the scripted UI workloads of the instrumented ggweb-bench,
+# which writes the profile into PGO_DIR. The raw Clang profiles are merged into PGO_DIR/default.profdata.
+#
+# Variables:
+#   BENCH     - the instrumented ggweb-bench
+#   PGO_DIR   - profile folder, as passed to -fprofile-generate
+#   PROFDATA  - llvm-profdata - Clang only
+
+foreach(VAR BENCH PGO_DIR)
+    if (NOT DEFINED ${VAR})
+        message(FATAL_ERROR "PGOTrain: ${VAR} is not set")
+    endif()
+endforeach()
+
+# the profiles of the previous runs would be accumulated
+file(REMOVE_RECURSE ${PGO_DIR})
+file(MAKE_DIRECTORY ${PGO_DIR})
+
+# all scenarios - they cover the layout, the text, the custom drawing and the tessellation
+execute_process(COMMAND ${BENCH} --frames 300 RESULT_VARIABLE RES)
+if (NOT RES EQUAL 0)
+    message(FATAL_ERROR "PGOTrain: the training run failed: ${RES}")
+endif()
+
+if (PROFDATA)
+    file(GLOB_RECURSE RAW_PROFILES "${PGO_DIR}/*.profraw")
+    if (NOT RAW_PROFILES)
+        message(FATAL_ERROR "PGOTrain: no profiles in ${PGO_DIR}")
+    endif()
+
+    execute_process(COMMAND ${PROFDATA} merge -output=${PGO_DIR}/default.profdata ${RAW_PROFILES} RESULT_VARIABLE RES)
+    if (NOT RES EQUAL 0)
+        message(FATAL_ERROR "PGOTrain: failed to merge the profiles: ${RES}")
+    endif()
+endif()
+
+message(STATUS "PGOTrain: the profile is in ${PGO_DIR} - reconfigure with -DCMAKE_BUILD_TYPE=PGOUse and rebuild")
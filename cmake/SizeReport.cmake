@@ -0,0 +1,76 @@
+# Size report of a build
+#
+# Run as a post-build step with cmake -P. Prints the size of each output file, compressed with gzip when available
+# (what goes over the wire on the web), and the size of the sections of the binary. The report is also written to
+# REPORT, so the sizes of the builds can be compared.
+#
+# Variables:
+#   FILE    - the binary - for the web, the .js next to which Emscripten places the .wasm and the .data
+#   REPORT  - output file
+
+foreach(VAR FILE REPORT)
+    if (NOT DEFINED ${VAR})
+        message(FATAL_ERROR "SizeReport: ${VAR} is not set")
+    endif()
+endforeach()
+
+set(FILES ${FILE})
+if (FILE MATCHES "\\.js$")
+    string(REGEX REPLACE "\\.js$" "" BASE ${FILE})
+    list(APPEND FILES ${BASE}.wasm ${BASE}.data)
+endif()
+
+find_program(GZIP_TOOL NAMES gzip)
+find_program(SIZE_TOOL NAMES llvm-size size)
+find_program(WASM_OBJDUMP_TOOL NAMES wasm-objdump)
+
+set(OUT "")
+set(TOTAL 0)
+set(TOTAL_GZIP 0)
+
+foreach(PATH ${FILES})
+    if (NOT EXISTS ${PATH})
+        continue()
+    endif()
+
+    get_filename_component(NAME ${PATH} NAME)
+    file(SIZE ${PATH} SIZE)
+    math(EXPR TOTAL "${TOTAL} + ${SIZE}")
+
+    set(LINE "${NAME}: ${SIZE} bytes")
+
+    if (GZIP_TOOL)
+        execute_process(
+            COMMAND ${GZIP_TOOL} -9 -c ${PATH}
+            OUTPUT_FILE ${REPORT}.gz
+            RESULT_VARIABLE RES)
+        if (RES EQUAL 0)
+            file(SIZE ${REPORT}.gz SIZE_GZIP)
+            math(EXPR TOTAL_GZIP "${TOTAL_GZIP} + ${SIZE_GZIP}")
+            set(LINE "${LINE}, ${SIZE_GZIP} gzipped")
+        endif()
+        file(REMOVE ${REPORT}.gz)
+    endif()
+
+    set(OUT "${OUT}${LINE}\n")
+
+    # section breakdown - the code and data sections of the binary
+    unset(SECTIONS)
+    if (NAME MATCHES "\\.wasm$" AND WASM_OBJDUMP_TOOL)
+        execute_process(COMMAND ${WASM_OBJDUMP_TOOL} -h ${PATH} OUTPUT_VARIABLE SECTIONS ERROR_QUIET)
+    elseif (NOT NAME MATCHES "\\.(js|data|html|wasm)$" AND SIZE_TOOL)
+        execute_process(COMMAND ${SIZE_TOOL} -A ${PATH} OUTPUT_VARIABLE SECTIONS ERROR_QUIET)
+    endif()
+
+    if (SECTIONS)
+        set(OUT "${OUT}${SECTIONS}\n")
+    endif()
+endforeach()
+
+set(OUT "${OUT}total: ${TOTAL} bytes")
+if (GZIP_TOOL)
+    set(OUT "${OUT}, ${TOTAL_GZIP} gzipped")
+endif()
+
+message(STATUS "Size report:\n${OUT}")
+file(WRITE ${REPORT} "${OUT}\n")
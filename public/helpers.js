@@ -9,6 +9,33 @@ function checkSharedArrayBuffer() {
     return true;
 }
 
+// message types of the data channels - must match MessageType in data-channel.h
+var MessageType = {
+    Text:    0,
+    Binary:  1,
+    Float32: 2,
+    User:    256,
+};
+
+// send a framed binary message to the native app - data is an ArrayBuffer or a typed array
+// the payload is written directly into the WASM heap
+function sendMessage(type, data) {
+    var bytes = data instanceof ArrayBuffer ?
+        new Uint8Array(data) :
+        new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+
+    var view = Module.dataInReserve(type, bytes.length);
+    if (view == null) {
+        console.warn('sendMessage: not enough space for ' + bytes.length + ' bytes');
+        return false;
+    }
+
+    view.set(bytes);
+    Module.dataInCommit();
+
+    return true;
+}
+
 function findGetParameter(parameterName) {
     var tmp = [];
     var result = null;
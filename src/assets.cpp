@@ -0,0 +1,144 @@
+#include "assets.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+
+// the URL of a file next to the page - mapped to the content-hashed name in the production build
+EM_JS(char *, ggwebLocateFile, (const char * path), {
+    var name = UTF8ToString(path);
+    var url = Module.locateFile ? Module.locateFile(name, '') : name;
+    var size = lengthBytesUTF8(url) + 1;
+    var res = _malloc(size);
+    stringToUTF8(url, res, size);
+    return res;
+});
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+AssetHandle Assets::request(const std::string & path, OnDone onDone) {
+    for (auto & entry : entries) {
+        if (entry->asset->path != path) {
+            continue;
+        }
+
+        // already delivered - call back on the next update() to keep the callbacks asynchronous
+        if (onDone) {
+            entry->onDone.push_back(std::move(onDone));
+            if (entry->asset->state != Asset::State::Pending) {
+                pending.push_back(entry);
+            }
+        }
+
+        return { entry->asset };
+    }
+
+    auto entry = std::make_shared<Entry>();
+    entry->asset = std::make_shared<Asset>();
+    entry->asset->path = path;
+    if (onDone) {
+        entry->onDone.push_back(std::move(onDone));
+    }
+
+    printf("Loading asset '%s'\n", path.c_str());
+
+#ifdef __EMSCRIPTEN__
+    {
+        // the entries are never removed, so the pointer stays valid until the fetch has finished
+        char * url = ggwebLocateFile(path.c_str());
+
+        emscripten_async_wget_data(url, entry.get(),
+            [](void * arg, void * buf, int size) {
+                auto entry = (Entry *) arg;
+                entry->data.assign((const uint8_t *) buf, (const uint8_t *) buf + size);
+                entry->isOk = true;
+                entry->isArrived = true;
+            },
+            [](void * arg) {
+                auto entry = (Entry *) arg;
+                entry->isArrived = true;
+            });
+
+        free(url);
+    }
+#else
+    entry->result = std::async(std::launch::async, [path, wakeUp = wakeUp]() {
+        std::shared_ptr<std::vector<uint8_t>> res;
+
+        std::ifstream f(path, std::ios::binary);
+        if (f.good()) {
+            res = std::make_shared<std::vector<uint8_t>>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+            if (f.bad()) {
+                res.reset();
+            }
+        }
+
+        if (wakeUp) {
+            wakeUp();
+        }
+
+        return res;
+    });
+#endif
+
+    entries.push_back(entry);
+    pending.push_back(entry);
+
+    return { entry->asset };
+}
+
+int Assets::update() {
+    int res = 0;
+
+    for (size_t i = 0; i < pending.size(); ) {
+        auto entry = pending[i];
+        auto & asset = *entry->asset;
+
+        if (asset.state == Asset::State::Pending) {
+#ifdef __EMSCRIPTEN__
+            if (entry->isArrived == false) {
+                ++i;
+                continue;
+            }
+
+            asset.data = std::move(entry->data);
+            asset.state = entry->isOk ? Asset::State::Ready : Asset::State::Failed;
+#else
+            if (entry->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++i;
+                continue;
+            }
+
+            auto data = entry->result.get();
+            if (data) {
+                asset.data = std::move(*data);
+            }
+            asset.state = data ? Asset::State::Ready : Asset::State::Failed;
+#endif
+
+            if (asset.state == Asset::State::Ready) {
+                printf("Loaded asset '%s' (%d bytes)\n", asset.path.c_str(), (int) asset.data.size());
+            } else {
+                fprintf(stderr, "Error: failed to load asset '%s'\n", asset.path.c_str());
+            }
+        }
+
+        pending.erase(pending.begin() + i);
+
+        // the callbacks can request more assets
+        auto onDone = std::move(entry->onDone);
+        entry->onDone.clear();
+        for (auto & fn : onDone) {
+            fn(asset);
+        }
+
+        ++res;
+    }
+
+    return res;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <cstdint> // uint8_t
+#include <functional>
+
+//
+// asynchronous asset loading
+//
+// the assets are loaded on demand, without blocking the main loop:
+//  - native: the file is read on a separate thread
+//  - web: the file is fetched from the server, next to the page, with emscripten_async_wget_data() - the URL goes
+//    through Module.locateFile(), so the production build can serve it under a content-hashed name
+//
+// the results are delivered on the main thread by update()
+//
+struct Asset {
+    enum class State {
+        Pending,
+        Ready,
+        Failed,
+    };
+
+    std::string path;
+
+    State state = State::Pending;
+    std::vector<uint8_t> data;
+};
+
+// non-blocking reference to an asset - check the state before using the data
+struct AssetHandle {
+    std::shared_ptr<const Asset> asset;
+
+    bool isValid()   const { return asset != nullptr; }
+    bool isPending() const { return asset && asset->state == Asset::State::Pending; }
+    bool isReady()   const { return asset && asset->state == Asset::State::Ready; }
+    bool isFailed()  const { return asset && asset->state == Asset::State::Failed; }
+};
+
+struct Assets {
+    using OnDone = std::function<void(const Asset & asset)>;
+
+    // called from any thread when an asset has arrived - update() has to be called to deliver it
+    std::function<void()> wakeUp;
+
+    // start loading the asset, unless it has already been requested
+    // onDone is called from update() when the asset is ready or has failed to load
+    AssetHandle request(const std::string & path, OnDone onDone = nullptr);
+
+    // deliver the arrived assets - call this from the main thread
+    // returns the number of assets that have been delivered
+    int update();
+
+    int nPending() const { return (int) pending.size(); }
+
+private:
+    struct Entry {
+        std::shared_ptr<Asset> asset;
+        std::vector<OnDone> onDone;
+
+        // native - the contents of the file, or nullptr if it cannot be read
+        std::future<std::shared_ptr<std::vector<uint8_t>>> result;
+
+        // web - set by the fetch callbacks
+        bool isArrived = false;
+        bool isOk = false;
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<std::shared_ptr<Entry>> entries;
+    std::vector<std::shared_ptr<Entry>> pending;
+};
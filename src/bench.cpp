@@ -0,0 +1,576 @@
+// Scripted UI workloads for measuring the CPU cost of building the UI
+//
+// No window or OpenGL context is created - the frames are built by Dear ImGui and the draw data is only inspected.
+// The time step and the window size are fixed, so the vertex, index and allocation counts are reproducible.
+
+#include "build-timestamp.h"
+
+#include "common.h"
+
+#include "state-core.h"
+#include "profiler.h"
+
+#include <imgui/imgui.h>
+#include <imgui-extra/imgui_impl.h>
+#include <imgui-extra/imgui_alloc.h>
+#include <imgui-extra/imgui_draw_simd.h>
+
+#include <cmath>
+#include <ctime>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <algorithm>
+
+namespace {
+
+//
+// Constants
+//
+
+// must match the value used by the app - the fonts are rendered as SDF at 1x
+const auto kFontScale = 1.00f;
+
+const auto kDisplayX = 1200.0f;
+const auto kDisplayY = 800.0f;
+
+const auto kWarmupFrames = 10;
+
+//
+// Scenarios
+//
+
+struct Scenario {
+    const char * name;
+    const char * description;
+
+    // called each frame after StateCore::render()
+    std::function<void(StateCore & stateCore, int frame)> update;
+};
+
+// deterministic pseudo-random numbers in [0, 1)
+float frand(uint32_t & state) {
+    state = state*1664525u + 1013904223u;
+    return (state >> 8)*(1.0f/16777216.0f);
+}
+
+std::string makeLongText(int nWords) {
+    static const char * kWords[] = {
+        "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit", "sed", "do", "eiusmod", "tempor",
+    };
+
+    uint32_t seed = 1;
+    std::string res;
+    for (int i = 0; i < nWords; ++i) {
+        res += kWords[(int) (frand(seed)*IM_ARRAYSIZE(kWords))];
+        res += (i % 16 == 15) ? "\n" : " ";
+    }
+
+    return res;
+}
+
+std::vector<Scenario> getScenarios() {
+    return {
+        {
+            "default", "the app UI without any extra load",
+            [](StateCore &, int) {
+            },
+        },
+        {
+            "widgets", "4000 widgets in a single window",
+            [](StateCore & stateCore, int) {
+                static bool checked[1000] = {};
+                static float values[1000] = {};
+
+                // taller than the display, so that all rows are submitted instead of being clipped by the window
+                const float height = 1000*ImGui::GetFrameHeightWithSpacing() + 2*ImGui::GetStyle().WindowPadding.y;
+
+                ImGui::SetNextWindowPos({ 0.0f, 0.0f });
+                ImGui::SetNextWindowSize({ kDisplayX, height });
+                ImGui::Begin("widgets");
+                {
+                    ImGui::FontSentry sentry(0, 1.0f/stateCore.fontScale);
+
+                    for (int i = 0; i < 1000; ++i) {
+                        ImGui::PushID(i);
+                        ImGui::Text("Item %d", i);
+                        ImGui::SameLine();
+                        ImGui::Button("Button");
+                        ImGui::SameLine();
+                        ImGui::Checkbox("Check", &checked[i]);
+                        ImGui::SameLine();
+                        ImGui::SliderFloat("Value", &values[i], 0.0f, 1.0f);
+                        ImGui::PopID();
+                    }
+                }
+                ImGui::End();
+            },
+        },
+        {
+            "circles", "20000 AddCircleFilled() calls",
+            [](StateCore &, int frame) {
+                auto drawList = ImGui::GetBackgroundDrawList();
+
+                uint32_t seed = 1;
+                for (int i = 0; i < 20000; ++i) {
+                    const float x = frand(seed)*kDisplayX;
+                    const float y = frand(seed)*kDisplayY;
+                    const float r = 2.0f + 8.0f*frand(seed) + std::sin(0.1f*frame);
+
+                    drawList->AddCircleFilled({ x, y }, r, IM_COL32(255, 128, 64, 200));
+                }
+            },
+        },
+        {
+            "circles-mt", "same as circles, recorded in 16 panels on the thread pool",
+            [](StateCore & stateCore, int frame) {
+                auto drawList = ImGui::GetBackgroundDrawList();
+
+                const int nPanels = 16;
+                for (int p = 0; p < nPanels; ++p) {
+                    stateCore.parallelDraw.add(drawList, [p, frame](ImDrawList & panel) {
+                        uint32_t seed = 1 + p;
+                        for (int i = 0; i < 20000/nPanels; ++i) {
+                            const float x = frand(seed)*kDisplayX;
+                            const float y = frand(seed)*kDisplayY;
+                            const float r = 2.0f + 8.0f*frand(seed) + std::sin(0.1f*frame);
+
+                            panel.AddCircleFilled({ x, y }, r, IM_COL32(255, 128, 64, 200));
+                        }
+                    });
+                }
+
+                stateCore.parallelDraw.flush(stateCore.threadPool);
+            },
+        },
+        {
+            "circles-bulk", "same as circles, with a single ImGui_AddCirclesFilled() call",
+            [](StateCore &, int frame) {
+                auto drawList = ImGui::GetBackgroundDrawList();
+
+                // kept between the frames, so only the draw list allocates
+                static std::vector<ImGuiCircle> circles(20000);
+
+                uint32_t seed = 1;
+                for (auto & circle : circles) {
+                    const float x = frand(seed)*kDisplayX;
+                    const float y = frand(seed)*kDisplayY;
+                    const float r = 2.0f + 8.0f*frand(seed) + std::sin(0.1f*frame);
+
+                    circle = { { x, y }, r, IM_COL32(255, 128, 64, 200) };
+                }
+
+                ImGui_AddCirclesFilled(drawList, circles.data(), (int) circles.size());
+            },
+        },
+        {
+            "lines", "20000 AddLine() calls",
+            [](StateCore &, int frame) {
+                auto drawList = ImGui::GetBackgroundDrawList();
+
+                uint32_t seed = 1;
+                for (int i = 0; i < 20000; ++i) {
+                    const float x = frand(seed)*kDisplayX;
+                    const float y = frand(seed)*kDisplayY;
+                    const float a = 0.1f*frame + 6.28f*frand(seed);
+
+                    // not a whole number of pixels - the stock lines are built from geometry as well
+                    drawList->AddLine({ x, y }, { x + 20.0f*std::cos(a), y + 20.0f*std::sin(a) }, IM_COL32(64, 128, 255, 200), 1.5f);
+                }
+            },
+        },
+        {
+            "lines-bulk", "same as lines, with a single ImGui_AddLines() call",
+            [](StateCore &, int frame) {
+                auto drawList = ImGui::GetBackgroundDrawList();
+
+                static std::vector<ImVec2> points(2*20000);
+
+                uint32_t seed = 1;
+                for (int i = 0; i < 20000; ++i) {
+                    const float x = frand(seed)*kDisplayX;
+                    const float y = frand(seed)*kDisplayY;
+                    const float a = 0.1f*frame + 6.28f*frand(seed);
+
+                    points[2*i + 0] = { x, y };
+                    points[2*i + 1] = { x + 20.0f*std::cos(a), y + 20.0f*std::sin(a) };
+                }
+
+                ImGui_AddLines(drawList, points.data(), 20000, IM_COL32(64, 128, 255, 200), 1.5f);
+            },
+        },
+        {
+            "text", "long wrapped text block",
+            [](StateCore & stateCore, int) {
+                static const std::string text = makeLongText(20000);
+
+                ImGui::SetNextWindowPos({ 0.0f, 0.0f });
+                ImGui::SetNextWindowSize({ kDisplayX, kDisplayY });
+                ImGui::Begin("text");
+                {
+                    ImGui::FontSentry sentry(0, 1.0f/stateCore.fontScale);
+
+                    ImGui::TextWrapped("%s", text.c_str());
+                }
+                ImGui::End();
+            },
+        },
+        {
+            "resize", "window resize every frame",
+            [](StateCore & stateCore, int frame) {
+                // same as AppInterface::setWindowSize() in the app
+                ImGui::GetIO().DisplaySize = {
+                    kDisplayX*(0.5f + 0.5f*((frame*7) % 32)/32.0f),
+                    kDisplayY*(0.5f + 0.5f*((frame*5) % 32)/32.0f),
+                };
+
+                stateCore.onWindowResize();
+                stateCore.rendering.isAnimating = true;
+            },
+        },
+    };
+}
+
+struct Result {
+    float cpu_ms = 0.0f;
+    float wallMin_ms = 1e9f;
+    float wallAvg_ms = 0.0f;
+
+    int64_t nVertices = 0;
+    int64_t nIndices = 0;
+    int64_t nDrawCalls = 0;
+    int64_t nAllocs = 0;
+    int64_t nBytes = 0;
+    int64_t nAllocsHeap = 0;
+};
+
+Result runScenario(const Scenario & scenario, int nFrames) {
+    // same allocator as the app - it also counts the allocations
+    ImGui_InstallAllocator();
+    ImGui::CreateContext();
+
+    auto & io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = { kDisplayX, kDisplayY };
+    io.DeltaTime = 1.0f/60.0f;
+
+    // build the font atlas without uploading it anywhere
+    {
+        ImFontConfig cfg;
+        cfg.SizePixels = 13.0f*kFontScale;
+        io.Fonts->AddFontDefault(&cfg);
+
+        unsigned char * pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+
+    StateCore stateCore;
+    stateCore.init(kFontScale);
+
+    Result res;
+
+    clock_t tCpu = 0;
+    int64_t tWall_us = 0;
+
+    for (int frame = -kWarmupFrames; frame < nFrames; ++frame) {
+        const bool isMeasured = frame >= 0;
+
+        ImGui_AllocNewFrame();
+
+        const clock_t tCpuStart = clock();
+        const int64_t tWallStart_us = Profiler::time_us();
+
+        stateCore.updatePre();
+
+        ImGui::NewFrame();
+        stateCore.render();
+        scenario.update(stateCore, frame);
+        ImGui::Render();
+
+        stateCore.updatePost();
+
+        const int64_t tWallFrame_us = Profiler::time_us() - tWallStart_us;
+
+        if (isMeasured == false) {
+            continue;
+        }
+
+        tCpu += clock() - tCpuStart;
+        tWall_us += tWallFrame_us;
+        res.wallMin_ms = std::min(res.wallMin_ms, 1e-3f*tWallFrame_us);
+
+        const auto drawData = ImGui::GetDrawData();
+        for (int l = 0; l < drawData->CmdListsCount; ++l) {
+            for (const auto & cmd : drawData->CmdLists[l]->CmdBuffer) {
+                res.nDrawCalls += cmd.UserCallback == nullptr;
+            }
+        }
+        res.nVertices += drawData->TotalVtxCount;
+        res.nIndices  += drawData->TotalIdxCount;
+        const auto allocStats = ImGui_GetAllocStats(true);
+        res.nAllocs     += allocStats.nAllocs;
+        res.nBytes      += allocStats.nBytes;
+        res.nAllocsHeap += allocStats.nAllocsHeap;
+    }
+
+    stateCore.deinitMain();
+    ImGui::DestroyContext();
+
+    res.cpu_ms       = (1000.0f*tCpu/CLOCKS_PER_SEC)/nFrames;
+    res.wallAvg_ms   = (1e-3f*tWall_us)/nFrames;
+    res.nVertices   /= nFrames;
+    res.nIndices    /= nFrames;
+    res.nDrawCalls  /= nFrames;
+    res.nAllocs     /= nFrames;
+    res.nBytes      /= nFrames;
+    res.nAllocsHeap /= nFrames;
+
+    return res;
+}
+
+//
+// Verification
+//
+
+// the primitives of imgui_draw_simd.h, including the degenerate cases
+void drawSimdPrimitives(ImDrawList & drawList) {
+    uint32_t seed = 7;
+
+    std::vector<ImGuiCircle> circles;
+    for (int i = 0; i < 5000; ++i) {
+        const float x = frand(seed)*kDisplayX;
+        const float y = frand(seed)*kDisplayY;
+        const float r = 0.25f + 100.0f*frand(seed)*frand(seed);
+
+        circles.push_back({ { x, y }, r, IM_COL32(255, 128, 64, i % 100 == 0 ? 0 : 200) });
+    }
+
+    ImGui_AddCirclesFilled(&drawList, circles.data(), (int) circles.size());
+    ImGui_AddCirclesFilled(&drawList, circles.data(), 100, 7);
+    ImGui_AddCirclesFilled(&drawList, circles.data(), 100, 1000);
+
+    std::vector<ImVec2> points;
+    for (int i = 0; i < 2001; ++i) {
+        points.push_back({ frand(seed)*kDisplayX, frand(seed)*kDisplayY });
+    }
+
+    // zero-length edges
+    points[5] = points[4];
+    points[6] = points[4];
+
+    for (float thickness : { 0.5f, 1.0f, 1.5f, 4.0f, 13.0f }) {
+        ImGui_AddLines(&drawList, points.data(), 1000, IM_COL32_WHITE, thickness);
+        ImGui_AddPolyline(&drawList, points.data(), 2, IM_COL32_WHITE, ImDrawFlags_None, thickness);
+        ImGui_AddPolyline(&drawList, points.data(), 37, IM_COL32_WHITE, ImDrawFlags_None, thickness);
+        ImGui_AddPolyline(&drawList, points.data(), (int) points.size(), IM_COL32_WHITE, ImDrawFlags_Closed, thickness);
+    }
+
+    std::vector<ImVec2> poly;
+    for (int i = 0; i < 33; ++i) {
+        poly.push_back({ 100.0f + 50.0f*std::cos(0.19f*i), 100.0f + 50.0f*std::sin(0.19f*i) });
+    }
+
+    ImGui_AddConvexPolyFilled(&drawList, poly.data(), (int) poly.size(), IM_COL32_WHITE);
+    ImGui_AddConvexPolyFilled(&drawList, points.data(), 7, IM_COL32_WHITE);
+}
+
+// the vectorized paths must produce the same bits as the scalar one
+bool verifySimd() {
+    auto & io = ImGui::GetIO();
+
+    const auto levelDefault = ImGui_GetSimdLevel();
+
+    bool res = true;
+
+    {
+        ImDrawList reference(ImGui::GetDrawListSharedData());
+
+        for (auto level : { ImGuiSimdLevel::Scalar, ImGuiSimdLevel::SSE2, ImGuiSimdLevel::AVX2, }) {
+            const char * name = ImGui_GetSimdLevelName(level);
+
+            if (ImGui_SetSimdLevel(level) == false) {
+                printf("%-10s not supported\n", name);
+                continue;
+            }
+
+            const bool isReference = level == ImGuiSimdLevel::Scalar;
+
+            ImDrawList drawList(ImGui::GetDrawListSharedData());
+            ImDrawList & target = isReference ? reference : drawList;
+
+            target._ResetForNewFrame();
+            target.PushTextureID(io.Fonts->TexID);
+            target.PushClipRectFullScreen();
+            target.Flags = ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AntiAliasedFill;
+
+            drawSimdPrimitives(target);
+
+            if (isReference) {
+                printf("%-10s %d vertices, %d indices\n", name, target.VtxBuffer.Size, target.IdxBuffer.Size);
+                continue;
+            }
+
+            const bool isSame =
+                target.VtxBuffer.Size == reference.VtxBuffer.Size &&
+                target.IdxBuffer.Size == reference.IdxBuffer.Size &&
+                memcmp(target.VtxBuffer.Data, reference.VtxBuffer.Data, target.VtxBuffer.size_in_bytes()) == 0 &&
+                memcmp(target.IdxBuffer.Data, reference.IdxBuffer.Data, target.IdxBuffer.size_in_bytes()) == 0;
+
+            printf("%-10s %s\n", name, isSame ? "same as scalar" : "DIFFERENT from scalar");
+
+            res = res && isSame;
+        }
+    }
+
+    ImGui_SetSimdLevel(levelDefault);
+
+    return res;
+}
+
+// a command that starts above vertex 0 and spans more than 64K vertices has its indices uploaded as 32-bit -
+// the renderer must still read the vertices that the command refers to
+bool verifyStreamIndices() {
+    auto & io = ImGui::GetIO();
+
+    ImDrawList drawList(ImGui::GetDrawListSharedData());
+
+    drawList._ResetForNewFrame();
+    drawList.PushTextureID(io.Fonts->TexID);
+    drawList.PushClipRectFullScreen();
+    drawList.Flags = ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AntiAliasedFill;
+
+    drawList.AddRectFilled({ 0.0f, 0.0f }, { 10.0f, 10.0f }, IM_COL32_WHITE);
+
+    // starts a new command after the vertices of the rect
+    drawList.PushClipRect({ 1.0f, 1.0f }, { kDisplayX - 1.0f, kDisplayY - 1.0f });
+    drawSimdPrimitives(drawList);
+    drawList.PopClipRect();
+
+    const bool res = ImGui_CheckStreamIndices(&drawList);
+
+    printf("%-10s %d vertices, %d commands - %s\n", "indices", drawList.VtxBuffer.Size, drawList.CmdBuffer.Size,
+           res ? "packed correctly" : "WRONG packed indices");
+
+    return res;
+}
+
+bool verify() {
+    ImGui::CreateContext();
+
+    auto & io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = { kDisplayX, kDisplayY };
+    io.DeltaTime = 1.0f/60.0f;
+
+    {
+        unsigned char * pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+
+    // sets up the shared draw list data
+    ImGui::NewFrame();
+
+    bool res = verifySimd();
+    res = verifyStreamIndices() && res;
+
+    ImGui::EndFrame();
+    ImGui::DestroyContext();
+
+    return res;
+}
+
+void printUsage(int argc, char ** argv) {
+    printf("Usage: %s [options]\n", argc > 0 ? argv[0] : "ggweb-bench");
+    printf("  -h, --help                  show this help message\n");
+    printf("  --frames N                  number of measured frames per scenario (default: 300)\n");
+    printf("  --scenario NAME             run only the specified scenario\n");
+    printf("  --simd LEVEL                vertex generation: scalar, sse2, avx2 (default: best supported)\n");
+    printf("  --verify                    check the vectorized vertex generation against the scalar one and the packing\n");
+    printf("                              of the uploaded indices, then exit\n");
+    printf("\n");
+    printf("Scenarios:\n");
+    for (const auto & scenario : getScenarios()) {
+        printf("  %-27s %s\n", scenario.name, scenario.description);
+    }
+}
+
+}
+
+int main(int argc, char ** argv) {
+    printf("Build time: %s\n", BUILD_TIMESTAMP);
+
+    int nFrames = 300;
+    std::string scenarioName;
+    bool doVerify = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (arg == "--frames" && i + 1 < argc) {
+            nFrames = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--scenario" && i + 1 < argc) {
+            scenarioName = argv[++i];
+        } else if (arg == "--simd" && i + 1 < argc) {
+            const std::string name = argv[++i];
+
+            bool isSet = false;
+            for (auto level : { ImGuiSimdLevel::Scalar, ImGuiSimdLevel::SSE2, ImGuiSimdLevel::AVX2, }) {
+                if (name == ImGui_GetSimdLevelName(level)) {
+                    isSet = ImGui_SetSimdLevel(level);
+                }
+            }
+
+            if (isSet == false) {
+                fprintf(stderr, "Error: unsupported SIMD level '%s'\n", name.c_str());
+                return -1;
+            }
+        } else if (arg == "--verify") {
+            doVerify = true;
+        } else {
+            printUsage(argc, argv);
+            return arg == "-h" || arg == "--help" ? 0 : -1;
+        }
+    }
+
+    if (doVerify) {
+        printf("\n");
+        return verify() ? 0 : -1;
+    }
+
+    printf("Vertex generation: %s\n", ImGui_GetSimdLevelName(ImGui_GetSimdLevel()));
+
+    printf("\n");
+    printf("%-12s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+           "scenario", "cpu ms", "wall ms", "min ms", "vertices", "indices", "draws", "allocs", "alloc KB", "mallocs");
+
+    int nRun = 0;
+    for (const auto & scenario : getScenarios()) {
+        if (scenarioName.empty() == false && scenarioName != scenario.name) {
+            continue;
+        }
+
+        const auto res = runScenario(scenario, nFrames);
+
+        printf("%-12s %10.3f %10.3f %10.3f %10lld %10lld %10lld %10lld %10.1f %10lld\n",
+               scenario.name, res.cpu_ms, res.wallAvg_ms, res.wallMin_ms,
+               (long long) res.nVertices, (long long) res.nIndices, (long long) res.nDrawCalls,
+               (long long) res.nAllocs, res.nBytes/1024.0f, (long long) res.nAllocsHeap);
+
+        ++nRun;
+    }
+
+    if (nRun == 0) {
+        fprintf(stderr, "Error: unknown scenario '%s'\n", scenarioName.c_str());
+        return -1;
+    }
+
+    return 0;
+}
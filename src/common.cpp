@@ -2,15 +2,25 @@
 
 #include "common.h"
 
+#include "profiler.h"
+#include "render-thread.h"
+
 #include <imgui/imgui.h>
+#include <imgui/imgui_internal.h>
 #include <imgui-extra/imgui_impl.h>
+#include <imgui-extra/imgui_alloc.h>
 
 #include <SDL.h>
 #include <SDL_opengl.h>
 
+#include <cmath>
 #include <fstream>
+#include <iterator>
+#include <cstring>
+#include <deque>
 #include <vector>
-#include <array>
+#include <utility>
+#include <algorithm>
 
 namespace ImGui {
 
@@ -25,10 +35,508 @@ ImFontConfig getFontConfig(const FontInfo& fontInfo) {
     return config;
 }
 
+//
+// font atlas cache
+//
+
+const uint32_t kFontAtlasMagic   = 0x41464747; // "GGFA"
+const uint32_t kFontAtlasVersion = 2;
+
+// 64-bit FNV-1a
+uint64_t hashBytes(uint64_t hash, const void * data, size_t size) {
+    const uint8_t * p = (const uint8_t *) data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+template <typename T>
+uint64_t hashValue(uint64_t hash, const T & value) {
+    return hashBytes(hash, &value, sizeof(value));
+}
+
+template <typename T>
+void writeValue(std::vector<uint8_t> & out, const T & value) {
+    const uint8_t * p = (const uint8_t *) &value;
+    out.insert(out.end(), p, p + sizeof(value));
+}
+
+struct Reader {
+    const std::vector<uint8_t> & data;
+    size_t pos = 0;
+
+    template <typename T>
+    bool read(T & value) {
+        return read(&value, sizeof(value));
+    }
+
+    bool read(void * dst, size_t size) {
+        if (pos + size > data.size()) {
+            return false;
+        }
+
+        memcpy(dst, data.data() + pos, size);
+        pos += size;
+
+        return true;
+    }
+};
+
+//
+// fonts
+//
+
+struct FontEntry {
+    FontInfo info;
+
+    // glyphs to rasterize - only for fonts with on-demand glyphs
+    ImFontGlyphRangesBuilder glyphs;
+
+    // Dear ImGui keeps a pointer to the ranges, so they have to stay alive until the next rebuild
+    ImVector<ImWchar> ranges;
+
+    // AddFontAsync() - the contents of the font file, empty if it failed to load
+    bool isAsync = false;
+    bool isPending = false; // the data has not arrived yet
+    bool isMissing = false; // not in the current atlas
+    std::vector<uint8_t> data;
+};
+
+// deque, so that the entries (and the ranges) do not move when adding fonts
+std::deque<FontEntry> g_fonts;
+
+// new glyphs have been requested - rebuild the atlas before the next frame
+bool g_fontsDirty = false;
+
+struct FontAtlasCache {
+    std::string filename;
+    uint64_t key = 0;
+
+    // hash of the font files that the current atlas was built from - 0 if unknown
+    uint64_t dataKey = 0;
+
+    // store the atlas after the next rebuild
+    bool needSave = false;
+} g_fontAtlasCache;
+
+bool isOnDemand(const FontInfo & fontInfo) {
+    return fontInfo.glyphs != nullptr;
+}
+
+//
+// signed distance field fonts
+//
+
+// the glyphs are rasterized at this scale and the distance field is downsampled to 1x
+const int kSDFRasterScale = 3;
+
+// distance in 1x pixels covered by each half of the [0, 255] range
+const float kSDFSpread = 2.0f;
+
+// "infinite" squared distance for the distance transform
+const float kSDFInf = 1e20f;
+
+bool g_fontSDF = false;
+
+// squared euclidean distance transform of a sampled function in 1D (Felzenszwalb & Huttenlocher)
+void edt1d(const float * f, float * d, int n, int * v, float * z) {
+    int k = 0;
+
+    v[0] = 0;
+    z[0] = -kSDFInf;
+    z[1] = +kSDFInf;
+
+    for (int q = 1; q < n; ++q) {
+        float s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k]))/(2*q - 2*v[k]);
+        while (s <= z[k]) {
+            --k;
+            s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k]))/(2*q - 2*v[k]);
+        }
+
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = +kSDFInf;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        d[q] = (q - v[k])*(q - v[k]) + f[v[k]];
+    }
+}
+
+// in-place 2D version - columns first, then rows
+void edt2d(std::vector<float> & grid, int w, int h) {
+    const int n = std::max(w, h);
+
+    std::vector<float> f(n);
+    std::vector<float> d(n);
+    std::vector<float> z(n + 1);
+    std::vector<int>   v(n);
+
+    for (int x = 0; x < w; ++x) {
+        for (int y = 0; y < h; ++y) f[y] = grid[y*w + x];
+        edt1d(f.data(), d.data(), h, v.data(), z.data());
+        for (int y = 0; y < h; ++y) grid[y*w + x] = d[y];
+    }
+
+    for (int y = 0; y < h; ++y) {
+        edt1d(grid.data() + y*w, d.data(), w, v.data(), z.data());
+        std::copy(d.begin(), d.begin() + w, grid.begin() + y*w);
+    }
+}
+
+// replace the rasterized atlas with a distance field at 1/kSDFRasterScale of the resolution
+// the glyph metrics are scaled down accordingly, so the fonts behave as if they were rasterized at 1x
+bool convertToSDF(ImFontAtlas & atlas, int idWhiteRect) {
+    const int R = kSDFRasterScale;
+
+    const int wSrc = atlas.TexWidth;
+    const int hSrc = atlas.TexHeight;
+    const int wDst = (wSrc + R - 1)/R;
+    const int hDst = (hSrc + R - 1)/R;
+
+    unsigned char * src = atlas.TexPixelsAlpha8;
+    if (src == nullptr || wSrc <= 0 || hSrc <= 0) {
+        return false;
+    }
+
+    // solid block used instead of the white pixel - the distance at its center is large enough to be fully opaque
+    const auto & white = *atlas.GetCustomRectByIndex(idWhiteRect);
+    for (int y = white.Y; y < white.Y + white.Height; ++y) {
+        memset(src + y*wSrc + white.X, 255, white.Width);
+    }
+
+    // squared distances to the nearest pixel outside / inside the glyphs
+    std::vector<float> distIn(wSrc*hSrc);
+    std::vector<float> distOut(wSrc*hSrc);
+    for (int i = 0; i < wSrc*hSrc; ++i) {
+        const bool isInside = src[i] >= 128;
+        distIn[i]  = isInside ? kSDFInf : 0.0f;
+        distOut[i] = isInside ? 0.0f : kSDFInf;
+    }
+
+    edt2d(distIn,  wSrc, hSrc);
+    edt2d(distOut, wSrc, hSrc);
+
+    // box-filter the signed distances down to 1x and map [-spread, spread] to [0, 255]
+    unsigned char * dst = (unsigned char *) IM_ALLOC(wDst*hDst);
+    for (int oy = 0; oy < hDst; ++oy) {
+        for (int ox = 0; ox < wDst; ++ox) {
+            float sum = 0.0f;
+            int cnt = 0;
+
+            for (int y = oy*R; y < std::min(oy*R + R, hSrc); ++y) {
+                for (int x = ox*R; x < std::min(ox*R + R, wSrc); ++x) {
+                    const int i = y*wSrc + x;
+                    sum += distOut[i] == 0.0f ? std::sqrt(distIn[i]) - 0.5f : 0.5f - std::sqrt(distOut[i]);
+                    ++cnt;
+                }
+            }
+
+            const float d = sum/(cnt*R);
+            dst[oy*wDst + ox] = (unsigned char) std::min(255.0f, std::max(0.0f, 127.5f + 127.5f*d/kSDFSpread + 0.5f));
+        }
+    }
+
+    IM_FREE(atlas.TexPixelsAlpha8);
+    atlas.TexPixelsAlpha8 = dst;
+    atlas.TexWidth  = wDst;
+    atlas.TexHeight = hDst;
+    atlas.TexUvScale = { 1.0f/wDst, 1.0f/hDst };
+
+    // normalized coordinates of a source pixel in the new texture
+    const float su = 1.0f/(R*wDst);
+    const float sv = 1.0f/(R*hDst);
+
+    atlas.TexUvWhitePixel = { (white.X + 0.5f*white.Width)*su, (white.Y + 0.5f*white.Height)*sv };
+
+    for (ImFont * font : atlas.Fonts) {
+        font->FontSize /= R;
+        font->Ascent   /= R;
+        font->Descent  /= R;
+
+        for (auto & glyph : font->Glyphs) {
+            glyph.AdvanceX /= R;
+            glyph.X0 /= R; glyph.Y0 /= R; glyph.X1 /= R; glyph.Y1 /= R;
+            glyph.U0 *= su*wSrc; glyph.V0 *= sv*hSrc; glyph.U1 *= su*wSrc; glyph.V1 *= sv*hSrc;
+
+            // extend the visible glyphs with the padding, so that the edges are not cut off
+            if (glyph.X1 > glyph.X0) {
+                const float pad = kSDFSpread;
+                glyph.X0 -= pad; glyph.Y0 -= pad; glyph.X1 += pad; glyph.Y1 += pad;
+                glyph.U0 -= pad/wDst; glyph.V0 -= pad/hDst; glyph.U1 += pad/wDst; glyph.V1 += pad/hDst;
+            }
+        }
+
+        font->BuildLookupTable();
+    }
+
+    return true;
+}
+
+bool addToAtlas(FontEntry & entry) {
+    const auto & info = entry.info;
+
+    // added when the data arrives
+    if (entry.isAsync && (entry.isPending || entry.data.empty())) {
+        entry.isMissing = true;
+        return true;
+    }
+    entry.isMissing = false;
+
+    entry.ranges.clear();
+    if (isOnDemand(info)) {
+        entry.glyphs.BuildRanges(&entry.ranges);
+
+        // merging a font without glyphs does nothing
+        if (entry.ranges.Size <= 1 && info.merge) {
+            return true;
+        }
+    } else {
+        entry.ranges.push_back((ImWchar) info.rangeMin);
+        entry.ranges.push_back((ImWchar) info.rangeMax);
+        entry.ranges.push_back(0);
+    }
+
+    ImFontConfig config;
+    if (info.merge) {
+        config = getFontConfig(info);
+    }
+
+    // rasterize at a higher resolution - the size is reduced back after computing the distance field
+    const float scale = g_fontSDF ? kSDFRasterScale : 1.0f;
+    if (g_fontSDF) {
+        config.OversampleH = 1;
+        config.OversampleV = 1;
+        config.GlyphOffset = { scale*config.GlyphOffset.x, scale*config.GlyphOffset.y };
+    }
+
+    // the ranges of the default font are used when the full range is requested
+    const ImWchar * ranges = (info.filename.empty() && isOnDemand(info) == false) ? nullptr : entry.ranges.Data;
+
+    if (info.filename.empty()) {
+        config.SizePixels = scale*info.size;
+        config.GlyphRanges = ranges;
+        return ImGui::GetIO().Fonts->AddFontDefault(&config) != nullptr;
+    }
+
+    if (entry.isAsync) {
+        // the data stays with the entry, so it can be used for the next rebuilds
+        config.FontDataOwnedByAtlas = false;
+        return ImGui::GetIO().Fonts->AddFontFromMemoryTTF((void *) entry.data.data(), (int) entry.data.size(), scale*info.size, &config, ranges) != nullptr;
+    }
+
+    return ImGui::GetIO().Fonts->AddFontFromFileTTF(info.filename.c_str(), scale*info.size, &config, ranges) != nullptr;
+}
+
+bool hasPendingFonts() {
+    for (const auto & entry : g_fonts) {
+        if (entry.isPending) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// identifies the contents of the font files added with AddFontAsync()
+uint64_t getFontDataKey() {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const auto & entry : g_fonts) {
+        if (entry.isAsync) {
+            hash = hashBytes(hash, entry.data.data(), entry.data.size());
+        }
+    }
+
+    return hash;
+}
+
+// once all fonts have arrived, make sure that the atlas is built from them and store it in the cache
+void checkFontAtlasCache() {
+    auto & cache = g_fontAtlasCache;
+    if (cache.filename.empty() || hasPendingFonts()) {
+        return;
+    }
+
+    const uint64_t dataKey = getFontDataKey();
+    if (dataKey == cache.dataKey) {
+        return;
+    }
+
+    // the cached atlas has been built from different font files
+    if (cache.dataKey != 0) {
+        g_fontsDirty = true;
+    }
+
+    cache.dataKey = dataKey;
+    cache.needSave = true;
+}
+
+bool rebuildFonts() {
+    const int64_t tStart_us = Profiler::time_us();
+
+    auto & atlas = *ImGui::GetIO().Fonts;
+    atlas.Clear();
+
+    for (auto & entry : g_fonts) {
+        if (addToAtlas(entry) == false) {
+            fprintf(stderr, "Error: failed to load font '%s'\n", entry.info.filename.c_str());
+        }
+    }
+
+    if (BuildFontAtlas() == false) {
+        return false;
+    }
+
+    printf("Rebuilt %dx%d font atlas in %.2f ms\n", atlas.TexWidth, atlas.TexHeight, 1e-3f*(Profiler::time_us() - tStart_us));
+
+    return true;
+}
+
+//
+// damage tracking
+//
+
+struct DamageTracking {
+    bool enabled = false;
+
+    // the last presented frame is still on screen
+    bool isValid = false;
+
+    ImVec2 displaySize;
+    ImVec2 framebufferScale;
+
+    // hash of each ImDrawList of the last presented frame
+    std::vector<uint64_t> hashes;
+
+    uint64_t nSkipped = 0;
+} g_damage;
+
+// native only - when running, the frames are presented from this thread
+RenderThread g_renderThread;
+
+// fast hash of the vertex and index buffers - 8 bytes at a time
+uint64_t hashMemory(uint64_t hash, const void * data, size_t size) {
+    const uint8_t * p = (const uint8_t *) data;
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        hash = (hash ^ w)*0x9e3779b97f4a7c15ull;
+        hash ^= hash >> 29;
+    }
+
+    for (; i < size; ++i) {
+        hash = (hash ^ p[i])*0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+uint64_t hashDrawList(const ImDrawList & list) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    hash = hashMemory(hash, list.VtxBuffer.Data, list.VtxBuffer.Size*sizeof(ImDrawVert));
+    hash = hashMemory(hash, list.IdxBuffer.Data, list.IdxBuffer.Size*sizeof(ImDrawIdx));
+
+    // field by field, to skip the padding
+    for (const auto & cmd : list.CmdBuffer) {
+        hash = hashValue(hash, cmd.ClipRect);
+        hash = hashValue(hash, cmd.TextureId);
+        hash = hashValue(hash, cmd.VtxOffset);
+        hash = hashValue(hash, cmd.IdxOffset);
+        hash = hashValue(hash, cmd.ElemCount);
+        hash = hashValue(hash, cmd.UserCallback);
+        hash = hashValue(hash, cmd.UserCallbackData);
+    }
+
+    return hash;
+}
+
+// returns true if the draw data differs from the last presented frame
+bool hasDamage(const ImDrawData & drawData) {
+    auto & dt = g_damage;
+
+    bool res = dt.isValid == false ||
+        dt.displaySize.x != drawData.DisplaySize.x || dt.displaySize.y != drawData.DisplaySize.y ||
+        dt.framebufferScale.x != drawData.FramebufferScale.x || dt.framebufferScale.y != drawData.FramebufferScale.y ||
+        dt.hashes.size() != (size_t) drawData.CmdListsCount;
+
+    dt.hashes.resize(drawData.CmdListsCount);
+    for (int i = 0; i < drawData.CmdListsCount; ++i) {
+        const uint64_t hash = hashDrawList(*drawData.CmdLists[i]);
+        if (dt.hashes[i] != hash) {
+            dt.hashes[i] = hash;
+            res = true;
+        }
+    }
+
+    dt.displaySize = drawData.DisplaySize;
+    dt.framebufferScale = drawData.FramebufferScale;
+    dt.isValid = true;
+
+    return res;
+}
+
+// ImFontAtlas::TexReady is only present in newer versions of Dear ImGui
+template <typename T>
+auto setTexReady(T & atlas, int) -> decltype(atlas.TexReady = true, void()) { atlas.TexReady = true; }
+
+template <typename T>
+void setTexReady(T & , long) {}
+
+}
+
+void SetFontSDF(bool enable) {
+    g_fontSDF = enable;
+
+    ImGui_SetFontSDF(enable);
+}
+
+bool BuildFontAtlas() {
+    auto & atlas = *ImGui::GetIO().Fonts;
+
+    int idWhiteRect = -1;
+    if (g_fontSDF) {
+        // anti-aliased lines and the mouse cursors cannot be sampled from a distance field
+        atlas.Flags |= ImFontAtlasFlags_NoBakedLines | ImFontAtlasFlags_NoMouseCursors;
+
+        // keep room for the distance field around each glyph
+        atlas.TexGlyphPadding = (int) (2*kSDFSpread*kSDFRasterScale);
+
+        const int size = (int) (2*kSDFSpread + 2)*kSDFRasterScale;
+        idWhiteRect = atlas.AddCustomRectRegular(size, size);
+    }
+
+    if (atlas.Build() == false) {
+        return false;
+    }
+
+    if (g_fontSDF) {
+        return convertToSDF(atlas, idWhiteRect);
+    }
+
+    return true;
 }
 
 bool TryLoadFont(const FontInfo & fontInfo) {
-    {
+    if (RegisterFont(fontInfo) == false) {
+        return false;
+    }
+
+    return addToAtlas(g_fonts.back());
+}
+
+bool RegisterFont(const FontInfo & fontInfo) {
+    if (fontInfo.filename.empty() == false) {
         std::ifstream f(fontInfo.filename);
 
         if (f.good() == false) {
@@ -36,28 +544,303 @@ bool TryLoadFont(const FontInfo & fontInfo) {
         }
     }
 
-    // we need to keep the glyph ranges alive since for some reason Dear ImGui doesn't do it
-    static thread_local std::vector<std::array<ImWchar, 3>> glyphRanges;
-    if (glyphRanges.empty()) {
-        glyphRanges.reserve(128);
+    g_fonts.push_back({ fontInfo, {}, {}, false, false, false, {} });
+
+    auto & entry = g_fonts.back();
+    if (isOnDemand(fontInfo)) {
+        entry.glyphs.AddText(fontInfo.glyphs);
     }
-    if (glyphRanges.size() == glyphRanges.capacity()) {
+
+    return true;
+}
+
+bool AddFontAsync(const FontInfo & fontInfo, bool isInAtlas) {
+    if (fontInfo.filename.empty()) {
         return false;
     }
-    glyphRanges.push_back({{ (ImWchar) fontInfo.rangeMin, (ImWchar) fontInfo.rangeMax, 0, }});
 
-    if (fontInfo.merge) {
-        const ImFontConfig config = getFontConfig(fontInfo);
-        ImGui::GetIO().Fonts->AddFontFromFileTTF(fontInfo.filename.c_str(), fontInfo.size, &config, glyphRanges.back().data());
-    } else {
-        ImGui::GetIO().Fonts->AddFontFromFileTTF(fontInfo.filename.c_str(), fontInfo.size, NULL, glyphRanges.back().data());
+    g_fonts.push_back({ fontInfo, {}, {}, false, false, false, {} });
+
+    auto & entry = g_fonts.back();
+    if (isOnDemand(fontInfo)) {
+        entry.glyphs.AddText(fontInfo.glyphs);
     }
 
+    entry.isAsync = true;
+    entry.isPending = true;
+    entry.isMissing = isInAtlas == false;
+
     return true;
 }
 
+bool SetFontData(const std::string & filename, std::vector<uint8_t> data) {
+    bool res = false;
+
+    for (auto & entry : g_fonts) {
+        if (entry.isPending == false || entry.info.filename != filename) {
+            continue;
+        }
+
+        entry.isPending = false;
+        entry.data = std::move(data);
+
+        if (entry.isMissing && entry.data.empty() == false) {
+            g_fontsDirty = true;
+        }
+
+        res = true;
+    }
+
+    checkFontAtlasCache();
+
+    return res;
+}
+
+void SetFontAtlasCache(const std::string & filename, uint64_t key) {
+    g_fontAtlasCache.filename = filename;
+    g_fontAtlasCache.key = key;
+
+    checkFontAtlasCache();
+}
+
+bool RequestGlyphs(const char * text, const char * textEnd) {
+    bool res = false;
+
+    while ((textEnd == nullptr) ? *text : text < textEnd) {
+        unsigned int c = 0;
+        text += ImTextCharFromUtf8(&c, text, textEnd);
+        if (c == 0) {
+            break;
+        }
+
+        for (auto & entry : g_fonts) {
+            if (isOnDemand(entry.info) == false || c < entry.info.rangeMin || c > entry.info.rangeMax) {
+                continue;
+            }
+
+            if (entry.glyphs.GetBit(c) == false) {
+                entry.glyphs.SetBit(c);
+                g_fontsDirty = true;
+                res = true;
+            }
+        }
+    }
+
+    return res;
+}
+
+uint64_t GetFontAtlasKey(float fontScale, const std::vector<FontInfo> & fonts) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    hash = hashValue(hash, IMGUI_VERSION_NUM);
+    hash = hashValue(hash, sizeof(ImFontGlyph));
+    hash = hashValue(hash, fontScale);
+    hash = hashValue(hash, g_fontSDF);
+
+    for (const auto & font : fonts) {
+        hash = hashBytes(hash, font.filename.data(), font.filename.size());
+        hash = hashValue(hash, font.size);
+        hash = hashValue(hash, font.merge);
+        hash = hashValue(hash, font.rangeMin);
+        hash = hashValue(hash, font.rangeMax);
+        hash = hashValue(hash, font.glyphOffsetX);
+        hash = hashValue(hash, font.glyphOffsetY);
+        if (font.glyphs) {
+            hash = hashBytes(hash, font.glyphs, strlen(font.glyphs) + 1);
+        }
+    }
+
+    return hash;
+}
+
+bool SaveFontAtlas(const std::string & filename, uint64_t key) {
+    auto & atlas = *ImGui::GetIO().Fonts;
+
+    unsigned char * pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    atlas.GetTexDataAsAlpha8(&pixels, &width, &height);
+
+    if (pixels == nullptr) {
+        return false;
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(width*height + 1024);
+
+    writeValue(out, kFontAtlasMagic);
+    writeValue(out, kFontAtlasVersion);
+    writeValue(out, key);
+    writeValue(out, getFontDataKey());
+
+    writeValue(out, (int32_t) atlas.Flags);
+    writeValue(out, (int32_t) width);
+    writeValue(out, (int32_t) height);
+    writeValue(out, atlas.TexUvScale);
+    writeValue(out, atlas.TexUvWhitePixel);
+    writeValue(out, atlas.TexUvLines);
+
+    writeValue(out, (uint32_t) atlas.Fonts.Size);
+    for (const ImFont * font : atlas.Fonts) {
+        writeValue(out, font->FontSize);
+        writeValue(out, font->Ascent);
+        writeValue(out, font->Descent);
+        writeValue(out, (uint32_t) font->FallbackChar);
+        writeValue(out, (uint32_t) font->EllipsisChar);
+
+        writeValue(out, (uint32_t) font->Glyphs.Size);
+        for (const auto & glyph : font->Glyphs) {
+            writeValue(out, (uint32_t) glyph.Codepoint);
+            writeValue(out, glyph.AdvanceX);
+            writeValue(out, glyph.X0); writeValue(out, glyph.Y0); writeValue(out, glyph.X1); writeValue(out, glyph.Y1);
+            writeValue(out, glyph.U0); writeValue(out, glyph.V0); writeValue(out, glyph.U1); writeValue(out, glyph.V1);
+        }
+    }
+
+    out.insert(out.end(), pixels, pixels + width*height);
+
+    std::ofstream fout(filename, std::ios::binary);
+    if (fout.good() == false) {
+        return false;
+    }
+
+    fout.write((const char *) out.data(), out.size());
+
+    return fout.good();
+}
+
+bool LoadFontAtlas(const std::string & filename, uint64_t key) {
+    std::vector<uint8_t> data;
+    {
+        std::ifstream f(filename, std::ios::binary);
+        if (f.good() == false) {
+            return false;
+        }
+
+        data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    }
+
+    Reader reader { data };
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t keyCache = 0;
+    uint64_t dataKey = 0;
+    if (reader.read(magic) == false || magic != kFontAtlasMagic ||
+        reader.read(version) == false || version != kFontAtlasVersion ||
+        reader.read(keyCache) == false || keyCache != key ||
+        reader.read(dataKey) == false) {
+        return false;
+    }
+
+    int32_t flags = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+
+    auto & atlas = *ImGui::GetIO().Fonts;
+    atlas.Clear();
+
+    bool ok = true;
+
+    ok = ok && reader.read(flags);
+    ok = ok && reader.read(width);
+    ok = ok && reader.read(height);
+    ok = ok && reader.read(atlas.TexUvScale);
+    ok = ok && reader.read(atlas.TexUvWhitePixel);
+    ok = ok && reader.read(atlas.TexUvLines);
+
+    uint32_t nFonts = 0;
+    ok = ok && reader.read(nFonts);
+
+    // the atlas has to be set before adding glyphs
+    atlas.Flags = flags | ImFontAtlasFlags_NoMouseCursors;
+    atlas.TexWidth = width;
+    atlas.TexHeight = height;
+
+    for (uint32_t i = 0; ok && i < nFonts; ++i) {
+        ImFont * font = IM_NEW(ImFont);
+        atlas.Fonts.push_back(font);
+
+        font->ContainerAtlas = &atlas;
+
+        uint32_t fallbackChar = 0;
+        uint32_t ellipsisChar = 0;
+        uint32_t nGlyphs = 0;
+
+        ok = ok && reader.read(font->FontSize);
+        ok = ok && reader.read(font->Ascent);
+        ok = ok && reader.read(font->Descent);
+        ok = ok && reader.read(fallbackChar);
+        ok = ok && reader.read(ellipsisChar);
+        ok = ok && reader.read(nGlyphs);
+
+        font->FallbackChar = (ImWchar) fallbackChar;
+        font->EllipsisChar = (ImWchar) ellipsisChar;
+
+        for (uint32_t g = 0; ok && g < nGlyphs; ++g) {
+            uint32_t codepoint = 0;
+            float v[10];
+            ok = ok && reader.read(codepoint);
+            ok = ok && reader.read(v, sizeof(v));
+            if (ok) {
+                font->AddGlyph(nullptr, (ImWchar) codepoint, v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[0]);
+            }
+        }
+
+        font->BuildLookupTable();
+    }
+
+    ok = ok && width > 0 && height > 0 && reader.pos + (size_t) width*height == data.size();
+
+    if (ok == false) {
+        fprintf(stderr, "Error: font atlas cache '%s' is corrupted\n", filename.c_str());
+        atlas.Clear();
+        atlas.Flags = 0;
+        return false;
+    }
+
+    atlas.TexPixelsAlpha8 = (unsigned char *) IM_ALLOC(width*height);
+    memcpy(atlas.TexPixelsAlpha8, data.data() + reader.pos, width*height);
+
+    setTexReady(atlas, 0);
+
+    // verified when the font files arrive - see checkFontAtlasCache()
+    g_fontAtlasCache.dataKey = dataKey;
+
+    return true;
+}
 
 bool NewFrame(SDL_Window * window) {
+    // releases the transient allocations of the previous frame
+    ImGui_AllocNewFrame();
+
+    // rasterize the requested glyphs and upload the new atlas
+    if (g_fontsDirty) {
+        g_fontsDirty = false;
+
+        // wait for the render thread to finish with the old atlas before modifying it
+        g_renderThread.invoke([]() {});
+
+        if (rebuildFonts()) {
+            g_renderThread.invoke([]() {
+                ImGui_DestroyFontsTexture();
+                ImGui_CreateFontsTexture();
+            });
+        }
+
+        InvalidateFrame();
+    }
+
+    if (g_fontAtlasCache.needSave) {
+        g_fontAtlasCache.needSave = false;
+
+        if (SaveFontAtlas(g_fontAtlasCache.filename, g_fontAtlasCache.key)) {
+            printf("Saved font atlas to '%s'\n", g_fontAtlasCache.filename.c_str());
+        } else {
+            fprintf(stderr, "Warning: failed to save font atlas to '%s'\n", g_fontAtlasCache.filename.c_str());
+        }
+    }
+
     ImGui_NewFrame(window);
     ImGui::NewFrame();
 
@@ -65,23 +848,89 @@ bool NewFrame(SDL_Window * window) {
 }
 
 bool EndFrame(SDL_Window * window) {
+    {
+        Profiler::Sentry sentry(Profiler::ImGuiRender);
+        ImGui::Render();
+    }
+
+    // nothing changed - the last presented frame is still correct
+    if (g_damage.enabled && hasDamage(*ImGui::GetDrawData()) == false) {
+        ++g_damage.nSkipped;
+        ImGui::EndFrame();
+
+        return true;
+    }
+
     // Rendering
     int display_w, display_h;
     SDL_GetWindowSize(window, &display_w, &display_h);
+
+    if (g_renderThread.isRunning()) {
+        // blocks only if the render thread is still busy with the frame before the previous one
+        {
+            Profiler::Sentry sentry(Profiler::Swap);
+            g_renderThread.submit(ImGui::GetDrawData(), display_w, display_h);
+        }
+
+        ImGui::EndFrame();
+
+        return true;
+    }
+
     glViewport(0, 0, display_w, display_h);
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    ImGui::Render();
-    ImGui_RenderDrawData(ImGui::GetDrawData());
+    {
+        Profiler::Sentry sentry(Profiler::RenderDrawData);
+        ImGui_RenderDrawData(ImGui::GetDrawData());
+    }
 
-    SDL_GL_SwapWindow(window);
+    {
+        Profiler::Sentry sentry(Profiler::Swap);
+        SDL_GL_SwapWindow(window);
+    }
 
     ImGui::EndFrame();
 
     return true;
 }
 
+void SetDamageTracking(bool enable) {
+    g_damage.enabled = enable;
+    g_damage.isValid = false;
+}
+
+void InvalidateFrame() {
+    g_damage.isValid = false;
+}
+
+bool StartRenderThread(SDL_Window * window, void * context) {
+    return g_renderThread.start(window, context);
+}
+
+void StopRenderThread() {
+    g_renderThread.stop();
+}
+
+bool SetSwapInterval(int interval) {
+    // the swap interval is a property of the context, so it has to be set from the thread that owns it
+    bool res = false;
+    g_renderThread.invoke([&]() {
+        res = SDL_GL_SetSwapInterval(interval) == 0;
+    });
+
+    if (res == false) {
+        fprintf(stderr, "Warning: failed to set swap interval %d. Reason: %s\n", interval, SDL_GetError());
+    }
+
+    return res;
+}
+
+uint64_t GetSkippedFrames() {
+    return g_damage.nSkipped;
+}
+
 bool SetStyle() {
     ImGuiStyle & style = ImGui::GetStyle();
 
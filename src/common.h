@@ -3,7 +3,8 @@
 #include <imgui/imgui.h>
 
 #include <string>
-#include <cstdint> // uint32_t
+#include <vector>
+#include <cstdint> // uint32_t, uint64_t
 
 struct SDL_Window;
 
@@ -19,14 +20,77 @@ struct FontInfo {
     const uint32_t rangeMax;
     const float glyphOffsetX = 0.0f;
     const float glyphOffsetY = 0.0f;
+
+    // UTF-8 string with the glyphs from [rangeMin, rangeMax] to rasterize initially - nullptr to rasterize the full range
+    // more glyphs are added on demand with RequestGlyphs()
+    const char * glyphs = nullptr;
 };
 
+// render the text using signed distance fields - the glyphs are rasterized at 3x, converted to distances and
+// stored at 1x, so the text stays sharp at any scale without supersampling the whole atlas
+// call before loading the fonts
+void SetFontSDF(bool enable);
+
+// build the atlas from the added fonts - required in SDF mode, otherwise the atlas is built on the first frame
+bool BuildFontAtlas();
+
+// add the font to the atlas and remember it, so that the atlas can be rebuilt with more glyphs later
 bool TryLoadFont(const FontInfo& fontInfo);
 
+// remember the font without adding it to the atlas - use when the atlas has been loaded from the cache
+bool RegisterFont(const FontInfo& fontInfo);
+
+// add a font whose file is loaded asynchronously - the text is rendered with the other fonts until the file arrives
+// with SetFontData(), then the atlas is rebuilt with the font at the start of the next frame
+// isInAtlas - the font is already in the atlas, loaded from the cache, so it is not rebuilt unless the file differs
+bool AddFontAsync(const FontInfo& fontInfo, bool isInAtlas);
+
+// the contents of a font file added with AddFontAsync() - empty data if it failed to load
+bool SetFontData(const std::string & filename, std::vector<uint8_t> data);
+
+// request glyphs (UTF-8) of fonts that are rasterized on demand (FontInfo::glyphs != nullptr)
+// the missing glyphs are rasterized by rebuilding the atlas at the start of the next frame
+// the requests are explicit - Dear ImGui resolves the glyphs inside ImFont without a hook, so text that is drawn
+// without calling RequestGlyphs() first keeps showing the fallback glyph for the glyphs that are not in the atlas
+// returns true if any of the glyphs is not in the atlas yet - the current frame will show the fallback glyph for them
+bool RequestGlyphs(const char * text, const char * textEnd = nullptr);
+
+// font atlas cache - the rasterized atlas (pixels + glyph metrics) is stored in a binary file, so that
+// the fonts do not have to be rasterized on each start
+// the key identifies the font configuration - a cache with a different key is ignored
+// the cache also stores a hash of the font files, which is checked when the files arrive (see AddFontAsync())
+uint64_t GetFontAtlasKey(float fontScale, const std::vector<FontInfo> & fonts);
+bool SaveFontAtlas(const std::string & filename, uint64_t key);
+bool LoadFontAtlas(const std::string & filename, uint64_t key);
+
+// store the atlas in the cache once all fonts added with AddFontAsync() have arrived, unless it is up to date
+void SetFontAtlasCache(const std::string & filename, uint64_t key);
+
 // call at the start and end of each frame
 bool NewFrame(SDL_Window * window);
 bool EndFrame(SDL_Window * window);
 
+// damage tracking - EndFrame() skips the GPU submit and the swap when the draw data is identical to the last
+// presented frame (each ImDrawList is hashed and compared with the previous hash)
+void SetDamageTracking(bool enable);
+
+// force the next frame to be presented - for example, when the window contents have been lost
+void InvalidateFrame();
+
+// native only - present the frames from a separate thread, which takes over the GL context
+// EndFrame() hands a copy of the draw data to the render thread, so the next frame is built while the previous one
+// is submitted to the GPU - the Swap phase of the profiler then measures the time spent waiting for the render thread
+bool StartRenderThread(SDL_Window * window, void * context);
+
+// the GL context is current on the calling thread again after this call
+void StopRenderThread();
+
+// native only - 0 disables vsync, 1 enables it - safe to call while the render thread is running
+bool SetSwapInterval(int interval);
+
+// number of frames skipped by the damage tracking so far
+uint64_t GetSkippedFrames();
+
 // set default sytle
 bool SetStyle();
 
@@ -0,0 +1,123 @@
+#include "data-channel.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// written instead of a header when the next message did not fit before the end of the buffer
+constexpr uint32_t kWrapMarker = 0xFFFFFFFF;
+
+constexpr uint32_t kHeaderSize = sizeof(MessageHeader);
+
+uint64_t alignUp4(uint64_t n) {
+    return (n + 3) & ~uint64_t(3);
+}
+
+}
+
+bool DataChannel::init(size_t capacity) {
+    buffer.assign(alignUp4(capacity), 0);
+    head = 0;
+    tail = 0;
+    headReserved = 0;
+
+    return buffer.empty() == false;
+}
+
+bool DataChannel::push(uint32_t type, const void * data, uint32_t size) {
+    uint8_t * dst = reserve(type, size);
+    if (dst == nullptr) {
+        return false;
+    }
+
+    if (size > 0) {
+        memcpy(dst, data, size);
+    }
+
+    commit();
+
+    return true;
+}
+
+bool DataChannel::push(const std::string & data) {
+    return push((uint32_t) MessageType::Text, data.data(), (uint32_t) data.size());
+}
+
+uint8_t * DataChannel::reserve(uint32_t type, uint32_t size) {
+    const uint64_t capacity = buffer.size();
+    const uint64_t total = alignUp4(kHeaderSize + (uint64_t) size);
+
+    if (capacity == 0) {
+        return nullptr;
+    }
+
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    const uint64_t t = tail.load(std::memory_order_acquire);
+
+    const uint64_t offset = h % capacity;
+    const uint64_t padding = offset + total > capacity ? capacity - offset : 0;
+
+    if (padding + total > capacity - (h - t)) {
+        fprintf(stderr, "Warning: data channel is full - dropping message of %u bytes\n", size);
+        return nullptr;
+    }
+
+    // the message does not fit before the end of the buffer - continue from the start
+    if (padding > 0) {
+        memcpy(buffer.data() + offset, &kWrapMarker, sizeof(kWrapMarker));
+    }
+
+    const MessageHeader header = { size, type };
+
+    uint8_t * dst = buffer.data() + (h + padding) % capacity;
+    memcpy(dst, &header, kHeaderSize);
+
+    headReserved = h + padding + total;
+
+    return dst + kHeaderSize;
+}
+
+void DataChannel::commit() {
+    head.store(headReserved, std::memory_order_release);
+}
+
+const uint8_t * DataChannel::peek(MessageHeader & header) {
+    const uint64_t capacity = buffer.size();
+    const uint64_t h = head.load(std::memory_order_acquire);
+
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    if (capacity == 0 || t == h) {
+        return nullptr;
+    }
+
+    uint32_t marker = 0;
+    memcpy(&marker, buffer.data() + t % capacity, sizeof(marker));
+
+    // skip the padding at the end of the buffer
+    if (marker == kWrapMarker) {
+        t += capacity - t % capacity;
+        tail.store(t, std::memory_order_release);
+    }
+
+    memcpy(&header, buffer.data() + t % capacity, kHeaderSize);
+
+    return buffer.data() + t % capacity + kHeaderSize;
+}
+
+void DataChannel::pop() {
+    MessageHeader header;
+    if (peek(header) == nullptr) {
+        return;
+    }
+
+    tail.store(tail.load(std::memory_order_relaxed) + alignUp4(kHeaderSize + (uint64_t) header.size), std::memory_order_release);
+}
+
+bool DataChannel::empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+
+size_t DataChannel::used() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint> // uint8_t, uint32_t, uint64_t
+
+//
+// framed binary messages exchanged between the native app and the JS layer (or a local socket)
+//
+// wire format: [uint32 size][uint32 type][size bytes of payload] - little-endian
+//
+enum class MessageType : uint32_t {
+    Text    = 0, // UTF-8 text
+    Binary  = 1, // raw bytes
+    Float32 = 2, // array of 32-bit floats
+
+    User    = 256, // first type available for application-specific messages
+};
+
+struct MessageHeader {
+    uint32_t size;
+    uint32_t type;
+};
+
+//
+// single-producer / single-consumer ring buffer of messages
+//
+// each message is stored as a MessageHeader followed by the payload and is always contiguous in memory,
+// so the consumer can access it in-place without copying - on the web, the JS layer reads it through
+// a Uint8Array view of the WASM heap
+//
+struct DataChannel {
+    // allocate the ring buffer - the capacity is rounded up to a multiple of 4 bytes
+    bool init(size_t capacity);
+
+    // append a message - returns false if there is not enough free space
+    bool push(uint32_t type, const void * data, uint32_t size);
+    bool push(const std::string & data);
+
+    // reserve space for a message and write the payload in-place, then call commit()
+    // returns nullptr if there is not enough free space
+    uint8_t * reserve(uint32_t type, uint32_t size);
+    void commit();
+
+    // access the oldest message in-place - returns nullptr if there are no messages
+    // the data remains valid until pop() is called
+    const uint8_t * peek(MessageHeader & header);
+
+    // release the message returned by the last peek()
+    void pop();
+
+    bool empty() const;
+
+    // total number of bytes in use, including headers and padding
+    size_t used() const;
+
+private:
+    std::vector<uint8_t> buffer;
+
+    // total number of bytes written / read so far - the offset in the buffer is (pos % capacity)
+    std::atomic<uint64_t> head { 0 };
+    std::atomic<uint64_t> tail { 0 };
+
+    // position after the last reserved message
+    uint64_t headReserved = 0;
+};
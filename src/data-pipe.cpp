@@ -0,0 +1,269 @@
+#include "data-pipe.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+
+namespace {
+
+bool setNonBlocking(int fd) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+}
+
+DataPipe::~DataPipe() {
+    close();
+}
+
+bool DataPipe::open(const std::string & path, DataChannel & dataIn, DataChannel & dataOut, std::function<void()> onReceive) {
+    close();
+
+    sockaddr_un addr = {};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: socket path '%s' is too long\n", path.c_str());
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    unlink(path.c_str());
+
+    fdListen = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fdListen < 0 ||
+        bind(fdListen, (const sockaddr *) &addr, sizeof(addr)) != 0 ||
+        listen(fdListen, 1) != 0 ||
+        setNonBlocking(fdListen) == false) {
+        fprintf(stderr, "Error: failed to listen on '%s'. Reason: %s\n", path.c_str(), strerror(errno));
+        close();
+        return false;
+    }
+
+    if (pipe(fdWake) != 0 || setNonBlocking(fdWake[0]) == false || setNonBlocking(fdWake[1]) == false) {
+        fprintf(stderr, "Error: failed to create wake-up pipe. Reason: %s\n", strerror(errno));
+        close();
+        return false;
+    }
+
+    this->path = path;
+    this->dataIn = &dataIn;
+    this->dataOut = &dataOut;
+    this->onReceive = std::move(onReceive);
+
+    isRunning = true;
+    worker = std::thread([this]() { run(); });
+
+    printf("Data pipe listening on '%s'\n", path.c_str());
+
+    return true;
+}
+
+void DataPipe::close() {
+    if (worker.joinable()) {
+        isRunning = false;
+        notify();
+        worker.join();
+    }
+
+    for (int * fd : { &fdClient, &fdListen, &fdWake[0], &fdWake[1] }) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+
+    if (path.empty() == false) {
+        unlink(path.c_str());
+        path.clear();
+    }
+}
+
+void DataPipe::notify() {
+    if (fdWake[1] >= 0) {
+        const char c = 0;
+        [[maybe_unused]] const auto res = write(fdWake[1], &c, 1);
+    }
+}
+
+void DataPipe::run() {
+    // receive state - the payload is read directly into the reserved space in dataIn
+    MessageHeader rxHeader = {};
+    size_t rxHeaderBytes = 0;
+    uint8_t * rxPayload = nullptr;
+    size_t rxPayloadBytes = 0;
+    bool rxDiscard = false;
+
+    // send state - the messages are sent directly from dataOut
+    size_t txBytes = 0;
+
+    auto disconnect = [&]() {
+        printf("Data pipe client disconnected\n");
+        ::close(fdClient);
+        fdClient = -1;
+
+        rxHeaderBytes = 0;
+        rxPayloadBytes = 0;
+        txBytes = 0;
+    };
+
+    while (isRunning) {
+        MessageHeader txHeader = {};
+        const uint8_t * txData = dataOut->peek(txHeader);
+
+        // nobody to send the messages to
+        if (fdClient < 0) {
+            while (txData) {
+                dataOut->pop();
+                txData = dataOut->peek(txHeader);
+            }
+        }
+
+        pollfd fds[2] = {};
+        fds[0] = { fdWake[0], POLLIN, 0 };
+        fds[1] = fdClient >= 0 ?
+            pollfd { fdClient, (short) (POLLIN | (txData ? POLLOUT : 0)), 0 } :
+            pollfd { fdListen, POLLIN, 0 };
+
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error: data pipe poll failed. Reason: %s\n", strerror(errno));
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char buf[64];
+            while (read(fdWake[0], buf, sizeof(buf)) > 0) {}
+        }
+
+        if (fdClient < 0) {
+            if (fds[1].revents & POLLIN) {
+                fdClient = accept(fdListen, nullptr, nullptr);
+                if (fdClient >= 0) {
+                    setNonBlocking(fdClient);
+                    printf("Data pipe client connected\n");
+                }
+            }
+            continue;
+        }
+
+        if (fds[1].revents & (POLLERR | POLLHUP | POLLNVAL) && (fds[1].revents & POLLIN) == 0) {
+            disconnect();
+            continue;
+        }
+
+        // receive
+        if (fds[1].revents & POLLIN) {
+            bool hasNew = false;
+
+            while (true) {
+                ssize_t n = 0;
+
+                if (rxHeaderBytes < sizeof(rxHeader)) {
+                    n = read(fdClient, (uint8_t *) &rxHeader + rxHeaderBytes, sizeof(rxHeader) - rxHeaderBytes);
+                    if (n > 0) {
+                        rxHeaderBytes += n;
+                        if (rxHeaderBytes == sizeof(rxHeader)) {
+                            rxPayload = dataIn->reserve(rxHeader.type, rxHeader.size);
+                            rxPayloadBytes = 0;
+                            rxDiscard = rxPayload == nullptr;
+                        }
+                    }
+                } else if (rxPayloadBytes < rxHeader.size) {
+                    uint8_t scratch[4096];
+                    uint8_t * dst = rxDiscard ? scratch : rxPayload + rxPayloadBytes;
+                    size_t len = rxHeader.size - rxPayloadBytes;
+                    if (rxDiscard && len > sizeof(scratch)) len = sizeof(scratch);
+
+                    n = read(fdClient, dst, len);
+                    if (n > 0) {
+                        rxPayloadBytes += n;
+                    }
+                }
+
+                // message complete
+                if (rxHeaderBytes == sizeof(rxHeader) && rxPayloadBytes == rxHeader.size) {
+                    if (rxDiscard == false) {
+                        dataIn->commit();
+                        hasNew = true;
+                    }
+                    rxHeaderBytes = 0;
+                    rxPayloadBytes = 0;
+                    continue;
+                }
+
+                if (n == 0) {
+                    disconnect();
+                    break;
+                }
+
+                if (n < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        disconnect();
+                    }
+                    break;
+                }
+            }
+
+            if (hasNew && onReceive) {
+                onReceive();
+            }
+
+            if (fdClient < 0) {
+                continue;
+            }
+        }
+
+        // send - the header is stored right before the payload in the ring buffer
+        while (txData) {
+            const size_t total = sizeof(txHeader) + txHeader.size;
+
+            const ssize_t n = send(fdClient, txData - sizeof(txHeader) + txBytes, total - txBytes, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    disconnect();
+                }
+                break;
+            }
+
+            txBytes += n;
+            if (txBytes < total) {
+                break;
+            }
+
+            txBytes = 0;
+            dataOut->pop();
+            txData = dataOut->peek(txHeader);
+        }
+    }
+}
+
+#else
+
+DataPipe::~DataPipe() {
+}
+
+bool DataPipe::open(const std::string & , DataChannel & , DataChannel & , std::function<void()> ) {
+    fprintf(stderr, "Error: data pipe is not supported on this platform\n");
+    return false;
+}
+
+void DataPipe::close() {
+}
+
+void DataPipe::notify() {
+}
+
+void DataPipe::run() {
+}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "data-channel.h"
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+//
+// native transport for the data channels over a unix domain socket
+//
+// the app listens on the given path and serves a single client at a time, using the same framing
+// as the data channels: [uint32 size][uint32 type][payload]
+//
+// the socket is serviced by a separate thread, which is the consumer of dataOut and the producer of dataIn
+// not available on the web and on Windows
+//
+struct DataPipe {
+    ~DataPipe();
+
+    // onReceive is called from the pipe thread after new messages have been pushed to dataIn
+    bool open(const std::string & path, DataChannel & dataIn, DataChannel & dataOut, std::function<void()> onReceive);
+    void close();
+
+    // wake up the pipe thread to send the new messages in dataOut
+    void notify();
+
+    bool isOpen() const { return worker.joinable(); }
+
+private:
+    void run();
+
+    std::string path;
+
+    DataChannel * dataIn = nullptr;
+    DataChannel * dataOut = nullptr;
+    std::function<void()> onReceive;
+
+    int fdListen = -1;
+    int fdClient = -1;
+    int fdWake[2] = { -1, -1 };
+
+    std::thread worker;
+    std::atomic<bool> isRunning { false };
+};
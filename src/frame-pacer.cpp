@@ -0,0 +1,136 @@
+#include "frame-pacer.h"
+
+#include "profiler.h"
+
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+namespace {
+
+// weight of the last frame in the moving average of the frame duration
+constexpr float kBusyAlpha = 0.1f;
+
+const char * kPolicyNames[] = {
+    "vsync",
+    "fixed",
+    "adaptive",
+    "late-latch",
+};
+
+}
+
+bool FramePacer::set(PacingPolicy policy, float targetFPS) {
+    if ((int) policy < 0 || (int) policy >= (int) (sizeof(kPolicyNames)/sizeof(kPolicyNames[0]))) {
+        return false;
+    }
+
+    if (targetFPS > 1000.0f) {
+        return false;
+    }
+
+    this->policy = policy;
+    if (targetFPS > 0.0f) {
+        this->targetFPS = targetFPS;
+    }
+
+    return true;
+}
+
+int FramePacer::swapInterval() const {
+    switch (policy) {
+        case PacingPolicy::VSync:
+        case PacingPolicy::LateLatch:
+            return 1;
+        case PacingPolicy::Fixed:
+        case PacingPolicy::Adaptive:
+            return 0;
+    }
+
+    return 1;
+}
+
+void FramePacer::onInput() {
+    tLastInput_us = Profiler::time_us();
+}
+
+void FramePacer::beginFrame() {
+    tFrameStart_us = Profiler::time_us();
+}
+
+void FramePacer::endFrame(bool rendered) {
+    if (rendered == false) {
+        return;
+    }
+
+    tLastStart_us = tFrameStart_us;
+    tLastEnd_us = Profiler::time_us();
+
+    // the swap blocks until the vertical blank, so it is not part of the work that has to fit before the deadline
+    const int n = Profiler::nFrames();
+    if (n > 0) {
+        const float busy_us = 1e3f*(Profiler::frameTime_ms(n - 1, Profiler::Count) - Profiler::frameTime_ms(n - 1, Profiler::Swap));
+        busyAvg_us = busyAvg_us == 0.0f ? busy_us : busyAvg_us + kBusyAlpha*(busy_us - busyAvg_us);
+    }
+}
+
+float FramePacer::currentFPS() const {
+    switch (policy) {
+        case PacingPolicy::VSync:
+            return 0.0f;
+        case PacingPolicy::Fixed:
+        case PacingPolicy::LateLatch:
+            return targetFPS;
+        case PacingPolicy::Adaptive:
+            {
+                const bool isIdle = Profiler::time_us() - tLastInput_us > (int64_t) (1e6f*idleDelay_s);
+                return isIdle ? std::min(idleFPS, targetFPS) : targetFPS;
+            }
+    }
+
+    return 0.0f;
+}
+
+int64_t FramePacer::timeToNextFrame_us() const {
+    const float fps = currentFPS();
+    if (fps <= 0.0f || tLastEnd_us == 0) {
+        return 0;
+    }
+
+    const int64_t period_us = (int64_t) (1e6f/fps);
+
+    int64_t tNext_us = tLastStart_us + period_us;
+
+    // start the next frame just in time to be ready for the vertical blank that follows the last swap
+    if (policy == PacingPolicy::LateLatch) {
+        tNext_us = tLastEnd_us + period_us - (int64_t) busyAvg_us - (int64_t) (1e3f*latchMargin_ms);
+    }
+
+    return std::clamp(tNext_us - Profiler::time_us(), (int64_t) 0, period_us);
+}
+
+void FramePacer::wait() const {
+    const int64_t dt_us = timeToNextFrame_us();
+    if (dt_us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(dt_us));
+    }
+}
+
+const char * FramePacer::policyName(PacingPolicy policy) {
+    if ((int) policy < 0 || (int) policy >= (int) (sizeof(kPolicyNames)/sizeof(kPolicyNames[0]))) {
+        return "unknown";
+    }
+
+    return kPolicyNames[(int) policy];
+}
+
+bool FramePacer::parsePolicy(const std::string & name, PacingPolicy & policy) {
+    for (int i = 0; i < (int) (sizeof(kPolicyNames)/sizeof(kPolicyNames[0])); ++i) {
+        if (name == kPolicyNames[i]) {
+            policy = (PacingPolicy) i;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <cstdint> // int64_t
+
+//
+// frame pacing - decides when the next iteration of the main loop starts
+//
+// policies:
+//  - VSync     : the swap blocks until the vertical blank (default)
+//  - Fixed     : vsync off, a new frame starts every 1/targetFPS seconds - e.g. 30 fps for low-power displays
+//  - Adaptive  : like Fixed, but drops to idleFPS when there has been no input for idleDelay_s seconds and the
+//                frames are driven only by animations and scheduled updates
+//  - LateLatch : vsync on, the input is sampled as late as possible before the next vertical blank, based on the
+//                measured duration of the recent frames - lowers the input-to-photon latency
+//                targetFPS should match the refresh rate of the display
+//                not for use with the render thread - the Swap phase then measures the wait for the render thread
+//
+// this is independent of the idle throttling (Rendering::nUpdates), which decides if a frame is rendered at all
+//
+enum class PacingPolicy : int {
+    VSync     = 0,
+    Fixed     = 1,
+    Adaptive  = 2,
+    LateLatch = 3,
+};
+
+struct FramePacer {
+    PacingPolicy policy = PacingPolicy::VSync;
+
+    float targetFPS = 60.0f;
+
+    // Adaptive
+    float idleFPS = 10.0f;
+    float idleDelay_s = 1.0f;
+
+    // LateLatch - extra time left before the deadline to absorb variations in the frame duration
+    float latchMargin_ms = 2.0f;
+
+    // number of frames rendered after an input event and while animating, before the idle throttling kicks in
+    int nFramesAfterEvent = 5;
+    int nFramesAnimating = 2;
+
+    // select the policy - returns false if the parameters are invalid, in which case nothing is changed
+    // targetFPS <= 0 keeps the current target
+    bool set(PacingPolicy policy, float targetFPS);
+
+    // the swap interval needed by the current policy - apply it with ImGui::SetSwapInterval()
+    int swapInterval() const;
+
+    // call for each input event
+    void onInput();
+
+    // call at the start and at the end of each iteration of the main loop
+    void beginFrame();
+    void endFrame(bool rendered);
+
+    // frame rate that the pacer is aiming for at this moment - 0 means that the frames are paced by vsync
+    float currentFPS() const;
+
+    // time in microseconds until the next frame should start - 0 means now
+    int64_t timeToNextFrame_us() const;
+
+    // native only - sleep until the next frame should start
+    void wait() const;
+
+    static const char * policyName(PacingPolicy policy);
+    static bool parsePolicy(const std::string & name, PacingPolicy & policy);
+
+private:
+    int64_t tFrameStart_us = 0;
+
+    // last rendered frame
+    int64_t tLastStart_us = 0;
+    int64_t tLastEnd_us = 0;
+
+    int64_t tLastInput_us = 0;
+
+    // exponential moving average of the time spent building and submitting a frame, without waiting for vsync
+    float busyAvg_us = 0.0f;
+};
@@ -4,6 +4,9 @@
 
 #include "state-sdl.h"
 #include "state-core.h"
+#include "profiler.h"
+#include "data-pipe.h"
+#include "frame-pacer.h"
 
 #include "icons-font-awesome.h"
 
@@ -12,6 +15,9 @@
 #include <SDL.h>
 
 #include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
 #include <functional>
 
 #ifdef __EMSCRIPTEN__
@@ -27,8 +33,81 @@ namespace {
 // Constants
 //
 
-// this improves the quality of the font at the expense of a memory and load time
-const auto kFontScale = 3.00f;
+// render the text using signed distance fields - sharp at any scale, so the fonts do not need to be supersampled
+const auto kFontSDF = true;
+
+// without SDF, rasterizing at a larger scale improves the quality of the font at the expense of a memory and load time
+const auto kFontScale = kFontSDF ? 1.00f : 3.00f;
+
+// when idle, render a frame at least this often (in ms) even if nothing happens
+const auto kIdleRefresh_ms = 500;
+
+//
+// Command-line parameters
+//
+
+struct Params {
+    // dump the profiler data on exit - .csv or .json
+    std::string fnameProfile;
+
+    // native only - render this many frames offscreen as fast as possible and report statistics
+    int nFramesHeadless = 0;
+
+    // native only - exchange data channel messages over a unix domain socket at this path
+    std::string pathPipe;
+
+    // native only - present the frames from a separate GL thread
+    bool renderThread = false;
+
+    // frame pacing policy and target frame rate - 0 uses the refresh rate of the display
+    std::string pacing = "vsync";
+    float fps = 0.0f;
+};
+
+void printUsage(int argc, char ** argv) {
+    printf("Usage: %s [options]\n", argc > 0 ? argv[0] : "ggweb-app");
+    printf("  -h, --help                  show this help message\n");
+    printf("  --profile FILE              dump frame timings on exit (.csv or .json)\n");
+    printf("  --headless N                render N frames offscreen with vsync off and report fps\n");
+    printf("                              without a display, use SDL_VIDEODRIVER=offscreen\n");
+    printf("  --pipe PATH                 exchange data messages over a unix domain socket\n");
+    printf("  --render-thread             submit the frames to the GPU from a separate thread\n");
+    printf("  --pacing POLICY             frame pacing: vsync (default), fixed, adaptive or late-latch\n");
+    printf("  --fps N                     target frame rate for the pacing policy (default: display refresh rate)\n");
+}
+
+bool parseParams(int argc, char ** argv, Params & params) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (arg == "--profile" && i + 1 < argc) {
+            params.fnameProfile = argv[++i];
+        } else if (arg == "--headless" && i + 1 < argc) {
+            params.nFramesHeadless = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--pipe" && i + 1 < argc) {
+            params.pathPipe = argv[++i];
+        } else if (arg == "--render-thread") {
+            params.renderThread = true;
+        } else if (arg == "--pacing" && i + 1 < argc) {
+            params.pacing = argv[++i];
+        } else if (arg == "--fps" && i + 1 < argc) {
+            params.fps = std::max(0.0f, (float) atof(argv[++i]));
+        } else {
+            fprintf(stderr, "Error: unknown argument '%s'\n", arg.c_str());
+            return false;
+        }
+    }
+
+    // late latch schedules the frames from the duration of the swap, which the render thread hides
+    if (params.renderThread && params.pacing == "late-latch") {
+        fprintf(stderr, "Error: --pacing late-latch cannot be used with --render-thread\n");
+        return false;
+    }
+
+    return true;
+}
 
 //
 // App Interface
@@ -38,18 +117,42 @@ struct AppInterface {
     std::function<bool()>                     doInit;
     std::function<void(int, int)>             setWindowSize;
     std::function<void(const std::string & )> setData;
-    std::function<std::string()>              getData;
+    std::function<std::string()>              getData; // polling fallback - pops a single message from dataOut
     std::function<std::string()>              getClipboard;
     std::function<std::string()>              getURL;
+    std::function<std::string()>              getProfile;
+    std::function<bool(const std::string &, float)> setFramePacing; // policy name, target fps (0 - keep the current)
 
     std::function<bool()> mainLoop;
 
+    // notify the JS layer that there are new messages in dataOut
+    std::function<void()> notifyData;
+
+#ifndef __EMSCRIPTEN__
+    // transport for the data messages when running natively
+    DataPipe dataPipe;
+#endif
+
+    // native only - block until there is an event or a scheduled update is due
+    std::function<void()> waitIdle;
+
+    FramePacer framePacer;
+
     bool init(StateSDL & stateSDL, StateCore & stateCore);
 
+    StateCore * stateCore = nullptr;
+
 private:
     // setWindowSize
     int lastX = -1;
     int lastY = -1;
+
+    // waitIdle
+    bool hasNextUpdate = false;
+    uint32_t tNextUpdate_ms = 0;
+
+    // main loop timing currently used by the browser
+    float webFPS = -1.0f;
 } g_appInterface;
 
 #ifdef __EMSCRIPTEN__
@@ -73,11 +176,46 @@ EMSCRIPTEN_BINDINGS(ggweb) {
     emscripten::function("getData",       emscripten::optional_override([]() -> std::string           { return g_appInterface.getData(); }));
     emscripten::function("getClipboard",  emscripten::optional_override([]() -> std::string           { return g_appInterface.getClipboard(); }));
     emscripten::function("getURL",        emscripten::optional_override([]() -> std::string           { return g_appInterface.getURL(); }));
+    emscripten::function("getProfile",    emscripten::optional_override([]() -> std::string           { return g_appInterface.getProfile(); }));
+
+    // Module.setFramePacing("fixed", 30) - returns false for an unknown policy
+    emscripten::function("setFramePacing", emscripten::optional_override([](const std::string & policy, float fps) -> bool { return g_appInterface.setFramePacing(policy, fps); }));
+
+    // zero-copy access to the messages for the JS layer
+    // the returned { type, data } object contains a Uint8Array view of the WASM heap, which is valid only
+    // until dataOutPop() is called or the heap grows, so copy anything you want to keep
+    emscripten::function("dataOutPeek", emscripten::optional_override([]() -> emscripten::val {
+        MessageHeader header;
+        const auto data = g_appInterface.stateCore->dataOut.peek(header);
+        if (data == nullptr) {
+            return emscripten::val::null();
+        }
+
+        auto res = emscripten::val::object();
+        res.set("type", header.type);
+        res.set("data", emscripten::val(emscripten::typed_memory_view(header.size, data)));
+        return res;
+    }));
+    emscripten::function("dataOutPop", emscripten::optional_override([]() { g_appInterface.stateCore->dataOut.pop(); }));
+
+    // write a message for the app in-place - fill the returned Uint8Array and call dataInCommit()
+    // returns null if there is not enough space
+    emscripten::function("dataInReserve", emscripten::optional_override([](uint32_t type, uint32_t size) -> emscripten::val {
+        const auto data = g_appInterface.stateCore->dataIn.reserve(type, size);
+        if (data == nullptr) {
+            return emscripten::val::null();
+        }
+
+        return emscripten::val(emscripten::typed_memory_view(size, data));
+    }));
+    emscripten::function("dataInCommit", emscripten::optional_override([]() { g_appInterface.stateCore->dataIn.commit(); }));
 }
 
 #endif
 
 bool AppInterface::init(StateSDL & stateSDL, StateCore & stateCore) {
+    this->stateCore = &stateCore;
+
     doInit = [&]() {
         stateCore.init(kFontScale);
 
@@ -99,12 +237,18 @@ bool AppInterface::init(StateSDL & stateSDL, StateCore & stateCore) {
     };
 
     setData = [&](const std::string & data) {
-        printf("Received some data from the JS layer: %s\n", data.c_str());
+        stateCore.dataIn.push(data);
     };
 
     getData = [&]() {
-        const auto res = stateCore.dataDummy;
-        stateCore.dataDummy.clear();
+        std::string res;
+
+        MessageHeader header;
+        if (const auto data = stateCore.dataOut.peek(header)) {
+            res.assign((const char *) data, header.size);
+            stateCore.dataOut.pop();
+        }
+
         return res;
     };
 
@@ -120,35 +264,111 @@ bool AppInterface::init(StateSDL & stateSDL, StateCore & stateCore) {
         return res;
     };
 
+    notifyData = [&]() {
+#ifdef __EMSCRIPTEN__
+        EM_ASM({
+            if (Module.onData) Module.onData();
+        });
+#else
+        if (dataPipe.isOpen()) {
+            dataPipe.notify();
+            return;
+        }
+
+        // there is no JS layer - drop the messages
+        while (stateCore.dataOut.empty() == false) {
+            stateCore.dataOut.pop();
+        }
+#endif
+    };
+
+    getProfile = [&]() {
+        return Profiler::toJSON();
+    };
+
+    setFramePacing = [&](const std::string & name, float fps) {
+        PacingPolicy policy;
+        if (FramePacer::parsePolicy(name, policy) == false || framePacer.set(policy, fps) == false) {
+            fprintf(stderr, "Error: invalid frame pacing '%s' at %g fps\n", name.c_str(), fps);
+            return false;
+        }
+
+#ifndef __EMSCRIPTEN__
+        // on the web, the browser paces the main loop - see mainLoop()
+        ImGui::SetSwapInterval(framePacer.swapInterval());
+#endif
+
+        printf("Frame pacing: %s at %g fps\n", FramePacer::policyName(framePacer.policy), framePacer.targetFPS);
+
+        return true;
+    };
+
     mainLoop = [&]() {
         auto & nUpdates = stateCore.rendering.nUpdates;
 
+#ifdef __EMSCRIPTEN__
+        // requestAnimationFrame when paced by vsync, otherwise a timer
+        // there is no way to sample the input closer to the vertical blank, so late latching falls back to vsync
+        {
+            const float fps = framePacer.policy == PacingPolicy::LateLatch ? 0.0f : framePacer.currentFPS();
+            if (fps != webFPS) {
+                webFPS = fps;
+                if (fps > 0.0f) {
+                    emscripten_set_main_loop_timing(EM_TIMING_SETTIMEOUT, std::max(1, (int) (1000.0f/fps)));
+                } else {
+                    emscripten_set_main_loop_timing(EM_TIMING_RAF, 1);
+                }
+            }
+        }
+#endif
+
+        framePacer.beginFrame();
+
         // framerate throtling when idle
         {
             --nUpdates;
+#ifdef __EMSCRIPTEN__
+            // the browser drives the loop and waitIdle() is not used, so refresh every 30 idle frames
+            // natively, the idle refresh comes from the kIdleRefresh_ms deadline in waitIdle()
             if (nUpdates < -30) nUpdates = 0;
-            if (stateCore.rendering.isAnimating) nUpdates = std::max(nUpdates, 2);
+#endif
+            if (stateCore.rendering.isAnimating) nUpdates = std::max(nUpdates, framePacer.nFramesAnimating);
+
+            // a scheduled update is due - for example, the next step of a slow animation
+            if (hasNextUpdate && (int32_t) (SDL_GetTicks() - tNextUpdate_ms) >= 0) {
+                hasNextUpdate = false;
+                nUpdates = std::max(nUpdates, 1);
+            }
 
             if (stateCore.isInitialized == false) {
                 return true;
             }
         }
 
+        Profiler::beginFrame();
+
         // process window events
         {
+            Profiler::Sentry sentry(Profiler::Events);
+
             SDL_Event event;
             while (SDL_PollEvent(&event)) {
-                nUpdates = std::max(nUpdates, 5);
+                nUpdates = std::max(nUpdates, framePacer.nFramesAfterEvent);
+                if (event.type != SDL_USEREVENT) framePacer.onInput();
                 ImGui_ProcessEvent(&event);
                 if (event.type == SDL_QUIT) return false;
                 if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE && event.window.windowID == SDL_GetWindowID(stateSDL.window)) return false;
+                if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_EXPOSED) ImGui::InvalidateFrame();
             }
         }
 
         // update + render
         {
-            if (stateCore.updatePre() == false) {
-                return false;
+            {
+                Profiler::Sentry sentry(Profiler::UpdatePre);
+                if (stateCore.updatePre() == false) {
+                    return false;
+                }
             }
 
             if (nUpdates >= 0) {
@@ -156,36 +376,189 @@ bool AppInterface::init(StateSDL & stateSDL, StateCore & stateCore) {
                     return false;
                 }
 
-                stateCore.render();
+                {
+                    Profiler::Sentry sentry(Profiler::Render);
+                    stateCore.render();
+                }
 
                 if (ImGui::EndFrame(stateSDL.window) == false) {
                     return false;
                 }
+
+                // remember when the app wants to be updated next
+                hasNextUpdate = stateCore.rendering.nextUpdate >= 0.0f;
+                if (hasNextUpdate) {
+                    tNextUpdate_ms = SDL_GetTicks() + (uint32_t) (1000.0f*stateCore.rendering.nextUpdate);
+                }
             }
 
-            if (stateCore.updatePost() == false) {
-                return false;
+            {
+                Profiler::Sentry sentry(Profiler::UpdatePost);
+                if (stateCore.updatePost() == false) {
+                    return false;
+                }
             }
         }
 
+        Profiler::endFrame(nUpdates >= 0);
+        framePacer.endFrame(nUpdates >= 0);
+
+        if (stateCore.dataOut.empty() == false) {
+            notifyData();
+        }
+
         return true;
     };
 
+    waitIdle = [&]() {
+        auto & nUpdates = stateCore.rendering.nUpdates;
+
+        // there are still frames to be rendered
+        if (nUpdates > 0 || stateCore.rendering.isAnimating) {
+            return;
+        }
+
+        const uint32_t tNow_ms = SDL_GetTicks();
+
+        uint32_t tDeadline_ms = tNow_ms + kIdleRefresh_ms;
+        if (hasNextUpdate && (int32_t) (tNextUpdate_ms - tDeadline_ms) < 0) {
+            tDeadline_ms = tNextUpdate_ms;
+        }
+
+        const int32_t timeout_ms = (int32_t) (tDeadline_ms - tNow_ms);
+        if (timeout_ms > 0 && SDL_WaitEventTimeout(nullptr, timeout_ms) == 1) {
+            // the event will be processed by the next mainLoop() call
+            return;
+        }
+
+        // deadline reached - render a single frame
+        hasNextUpdate = false;
+        nUpdates = 1;
+    };
+
+    return true;
+}
+
+#ifndef __EMSCRIPTEN__
+
+// render frames back to back without any throttling and print statistics
+bool runHeadless(StateSDL & stateSDL, StateCore & stateCore, int nFrames) {
+    // the fonts are loaded asynchronously - wait for them, so that the measured frames do not include
+    // the atlas rebuilds or the fallback text
+    while (stateCore.assets.nPending() > 0) {
+        stateCore.assets.update();
+        SDL_Delay(1);
+    }
+
+    // two frames that are not measured - the first one rebuilds the atlas with the arrived fonts and requests the
+    // glyphs drawn by the app, which the second one rasterizes
+    for (int i = 0; i < 2; ++i) {
+        stateCore.updatePre();
+        ImGui::NewFrame(stateSDL.window);
+        stateCore.render();
+        ImGui::EndFrame(stateSDL.window);
+        stateCore.updatePost();
+    }
+
+    printf("Running %d headless frames\n", nFrames);
+
+    int64_t nDrawCalls = 0;
+    int64_t nVertices = 0;
+    int64_t nIndices = 0;
+
+    const int64_t tStart_us = Profiler::time_us();
+
+    for (int i = 0; i < nFrames; ++i) {
+        Profiler::beginFrame();
+
+        // keep the event queue empty
+        {
+            Profiler::Sentry sentry(Profiler::Events);
+
+            SDL_Event event;
+            while (SDL_PollEvent(&event)) {
+                ImGui_ProcessEvent(&event);
+                if (event.type == SDL_QUIT) return false;
+            }
+        }
+
+        {
+            Profiler::Sentry sentry(Profiler::UpdatePre);
+            stateCore.updatePre();
+        }
+
+        ImGui::NewFrame(stateSDL.window);
+
+        {
+            Profiler::Sentry sentry(Profiler::Render);
+            stateCore.render();
+        }
+
+        ImGui::EndFrame(stateSDL.window);
+
+        {
+            Profiler::Sentry sentry(Profiler::UpdatePost);
+            stateCore.updatePost();
+        }
+
+        Profiler::endFrame(true);
+
+        // the draw data remains valid until the next ImGui::NewFrame()
+        if (const auto drawData = ImGui::GetDrawData()) {
+            for (int l = 0; l < drawData->CmdListsCount; ++l) {
+                for (const auto & cmd : drawData->CmdLists[l]->CmdBuffer) {
+                    nDrawCalls += cmd.UserCallback == nullptr;
+                }
+            }
+            nVertices += drawData->TotalVtxCount;
+            nIndices  += drawData->TotalIdxCount;
+        }
+    }
+
+    const float tElapsed_s = 1e-6f*(Profiler::time_us() - tStart_us);
+
+    printf("Headless results:\n");
+    printf("  frames:           %d\n", nFrames);
+    printf("  time:             %.3f s\n", tElapsed_s);
+    printf("  fps:              %.1f\n", nFrames/tElapsed_s);
+    printf("  frame time p50:   %.3f ms\n", Profiler::percentile_ms(Profiler::Count, 50.0f));
+    printf("  frame time p99:   %.3f ms\n", Profiler::percentile_ms(Profiler::Count, 99.0f));
+    printf("  draw calls/frame: %.1f\n", (double) nDrawCalls/nFrames);
+    printf("  vertices/frame:   %.1f\n", (double) nVertices/nFrames);
+    printf("  indices/frame:    %.1f\n", (double) nIndices/nFrames);
+
     return true;
 }
 
+#endif
+
 }
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+int main(int argc, char** argv) {
     printf("Build time: %s\n", BUILD_TIMESTAMP);
 
+    Params params;
+    if (parseParams(argc, argv, params) == false) {
+        printUsage(argc, argv);
+        return -1;
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         fprintf(stderr, "Error: failed to initialize SDL. Reason: %s\n", SDL_GetError());
         return -1;
     }
 
     StateCore stateCore;
-    StateSDL stateSDL = { .windowX = 1200, .windowY = 800, };
+
+    // wake up the main loop - can be called from any thread
+    stateCore.wakeUp = []() {
+        SDL_Event event = {};
+        event.type = SDL_USEREVENT;
+        SDL_PushEvent(&event);
+    };
+    stateCore.assets.wakeUp = stateCore.wakeUp;
+
+    StateSDL stateSDL = { .windowX = 1200, .windowY = 800, .isHeadless = params.nFramesHeadless > 0, .fnameFontAtlas = "ggweb-fonts.atlas", .fontSDF = kFontSDF, };
 
     // initialize SDL + ImGui
     {
@@ -198,12 +571,17 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
                         kFontScale,
                         {
                             // add fonts to be loaded
-                            { .filename = "fontawesome-webfont.ttf", .size = 14.0f*kFontScale, .merge = true, .rangeMin = ICON_MIN_FA, .rangeMax = ICON_MAX_FA, },
+                            // only the listed icons are rasterized initially, the rest are added with ImGui::RequestGlyphs()
+                            { .filename = "fontawesome-webfont.ttf", .size = 14.0f*kFontScale, .merge = true, .rangeMin = ICON_MIN_FA, .rangeMax = ICON_MAX_FA, .glyphs = ICON_FA_COG, },
                             //{ .filename = "some-cool-font.ttf", .size = 14.0f*kFontScale, .merge = false, .rangeMin = ..., .rangeMax = ..., },
-                        }) == false) {
+                        },
+                        stateCore.assets) == false) {
             fprintf(stderr, "Error: failed to initialize ImGui.\n");
             return -3;
         }
+
+        // the headless benchmark measures the full render path
+        ImGui::SetDamageTracking(stateSDL.isHeadless == false);
     }
 
     // initialize the application interface
@@ -227,25 +605,69 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
             return -5;
         }
 
-        // main loop
-        while (true) {
-            if (g_appInterface.mainLoop() == false) {
-                printf("Main loop exited\n");
-                break;
+        if (params.pathPipe.empty() == false) {
+            if (g_appInterface.dataPipe.open(params.pathPipe, stateCore.dataIn, stateCore.dataOut, stateCore.wakeUp) == false) {
+                fprintf(stderr, "Error: failed to open data pipe '%s'\n", params.pathPipe.c_str());
+                return -6;
             }
+        }
 
-            // update window size
-            {
-                int sizeX = -1;
-                int sizeY = -1;
+        if (stateSDL.isHeadless) {
+            // benchmark
+            if (runHeadless(stateSDL, stateCore, params.nFramesHeadless) == false) {
+                printf("Headless run interrupted\n");
+            }
+        } else {
+            // the next frame is built while the previous one is rendered
+            if (params.renderThread && ImGui::StartRenderThread(stateSDL.window, stateSDL.context) == false) {
+                fprintf(stderr, "Warning: failed to start the render thread - rendering from the main thread\n");
+            }
 
-                SDL_GetWindowSize(stateSDL.window, &sizeX, &sizeY);
-                g_appInterface.setWindowSize(sizeX, sizeY);
+            // default to the refresh rate of the display
+            float fps = params.fps;
+            if (fps <= 0.0f) {
+                SDL_DisplayMode mode;
+                if (SDL_GetWindowDisplayMode(stateSDL.window, &mode) == 0 && mode.refresh_rate > 0) {
+                    fps = (float) mode.refresh_rate;
+                }
             }
+
+            if (g_appInterface.setFramePacing(params.pacing, fps) == false) {
+                return -7;
+            }
+
+            // main loop
+            while (true) {
+                if (g_appInterface.mainLoop() == false) {
+                    printf("Main loop exited\n");
+                    break;
+                }
+
+                // update window size
+                {
+                    int sizeX = -1;
+                    int sizeY = -1;
+
+                    SDL_GetWindowSize(stateSDL.window, &sizeX, &sizeY);
+                    g_appInterface.setWindowSize(sizeX, sizeY);
+                }
+
+                // sleep when there is nothing to do
+                g_appInterface.waitIdle();
+
+                // sleep until the next frame is due according to the pacing policy
+                g_appInterface.framePacer.wait();
+            }
+        }
+
+        if (params.fnameProfile.empty() == false) {
+            Profiler::dump(params.fnameProfile);
         }
 
         // cleanup
         {
+            g_appInterface.dataPipe.close();
+            ImGui::StopRenderThread();
             stateCore.deinitMain();
             stateSDL.deinitImGui();
             stateSDL.deinitWindow();
@@ -0,0 +1,180 @@
+#include "parallel-draw.h"
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+// minimum reservation of the panel lists - the first frame has no sizes to go by
+const int kMinReserveVtx  = 1024;
+const int kMinReserveIdx  = 2048;
+const int kMinReserveCmd  = 16;
+const int kMinReservePath = 512;
+
+// marks the position of a panel in the target list until flush() replaces it - UserCallbackData is the panel index
+// does nothing if it ever reaches the renderer
+void panelMarker(const ImDrawList * , const ImDrawCmd * ) {}
+
+int findMarker(const ImDrawList & list, int iPanel) {
+    for (int i = 0; i < list.CmdBuffer.Size; ++i) {
+        const auto & cmd = list.CmdBuffer[i];
+        if (cmd.UserCallback == panelMarker && cmd.UserCallbackData == (void *) (intptr_t) iPanel) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// replace the command iMarker of dst with the commands of src
+// the vertices of src are appended at the end of dst, and the indices are inserted at the position of the marker -
+// the commands after it are shifted
+void spliceDrawList(ImDrawList & dst, int iMarker, const ImDrawList & src) {
+    const unsigned int idxPos = dst.CmdBuffer[iMarker].IdxOffset;
+    const unsigned int vtxBase = dst.VtxBuffer.Size;
+
+    // the appended vertices are addressed with VtxOffset only for 16-bit indices and a renderer that supports it -
+    // ImGui sets ImDrawListFlags_AllowVtxOffset from ImGuiBackendFlags_RendererHasVtxOffset. otherwise the indices
+    // are rebased, since the stock GL renderer ignores VtxOffset without base vertex support (WebGL, GL < 3.2)
+    const bool useVtxOffset = sizeof(ImDrawIdx) == 2 && (dst.Flags & ImDrawListFlags_AllowVtxOffset);
+
+    int nCmds = 0;
+    for (const auto & cmd : src.CmdBuffer) {
+        if (cmd.ElemCount > 0 || cmd.UserCallback != nullptr) {
+            ++nCmds;
+        }
+    }
+
+    const int nVtx = src.VtxBuffer.Size;
+    const int nIdx = src.IdxBuffer.Size;
+
+    if (nVtx > 0) {
+        dst.VtxBuffer.resize(vtxBase + nVtx);
+        memcpy(dst.VtxBuffer.Data + vtxBase, src.VtxBuffer.Data, nVtx*sizeof(ImDrawVert));
+    }
+
+    if (nIdx > 0) {
+        const int nIdxOld = dst.IdxBuffer.Size;
+        dst.IdxBuffer.resize(nIdxOld + nIdx);
+        memmove(dst.IdxBuffer.Data + idxPos + nIdx, dst.IdxBuffer.Data + idxPos, (nIdxOld - idxPos)*sizeof(ImDrawIdx));
+
+        if (useVtxOffset) {
+            memcpy(dst.IdxBuffer.Data + idxPos, src.IdxBuffer.Data, nIdx*sizeof(ImDrawIdx));
+        } else {
+            for (const auto & cmd : src.CmdBuffer) {
+                const unsigned int base = vtxBase + cmd.VtxOffset;
+
+                const ImDrawIdx * idxSrc = src.IdxBuffer.Data + cmd.IdxOffset;
+                ImDrawIdx * idxDst = dst.IdxBuffer.Data + idxPos + cmd.IdxOffset;
+                for (unsigned int k = 0; k < cmd.ElemCount; ++k) {
+                    idxDst[k] = (ImDrawIdx) (base + idxSrc[k]);
+                }
+            }
+        }
+    }
+
+    // nCmds commands in place of the marker
+    const int nCmdsOld = dst.CmdBuffer.Size;
+    const int nAfter = nCmdsOld - iMarker - 1;
+    if (nCmds > 1) {
+        dst.CmdBuffer.resize(nCmdsOld + nCmds - 1);
+    }
+    memmove(dst.CmdBuffer.Data + iMarker + nCmds, dst.CmdBuffer.Data + iMarker + 1, nAfter*sizeof(ImDrawCmd));
+    if (nCmds < 1) {
+        dst.CmdBuffer.resize(nCmdsOld - 1);
+    }
+
+    ImDrawCmd * out = dst.CmdBuffer.Data + iMarker;
+    for (const auto & cmd : src.CmdBuffer) {
+        if (cmd.ElemCount == 0 && cmd.UserCallback == nullptr) {
+            continue;
+        }
+
+        *out = cmd;
+        out->VtxOffset = useVtxOffset ? cmd.VtxOffset + vtxBase : 0;
+        out->IdxOffset += idxPos;
+        ++out;
+    }
+
+    for (int i = iMarker + nCmds; i < dst.CmdBuffer.Size; ++i) {
+        dst.CmdBuffer[i].IdxOffset += nIdx;
+    }
+
+    // the buffers may have moved - the next primitives of dst are written at the end, after the appended vertices
+    dst._VtxWritePtr = dst.VtxBuffer.Data + dst.VtxBuffer.Size;
+    dst._IdxWritePtr = dst.IdxBuffer.Data + dst.IdxBuffer.Size;
+    if (nVtx > 0) {
+        if (useVtxOffset) {
+            dst._CmdHeader.VtxOffset = dst.VtxBuffer.Size;
+            dst._OnChangedVtxOffset();
+        } else {
+            dst._VtxCurrentIdx += nVtx;
+        }
+    }
+}
+
+}
+
+void ParallelDraw::addPanel(ImDrawList * target, void * closure, CallFn call, DestroyFn destroy) {
+    // the marker is a command of its own - ImGui does not merge commands with callbacks
+    target->AddCallback(panelMarker, (void *) (intptr_t) panels.size());
+
+    panels.push_back({ target, target->GetClipRectMin(), target->GetClipRectMax(), closure, call, destroy });
+}
+
+void ParallelDraw::flush(ThreadPool & threadPool) {
+    if (panels.empty()) {
+        return;
+    }
+
+    const int n = (int) panels.size();
+
+    while ((int) lists.size() < n) {
+        lists.push_back({ std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()), });
+    }
+
+    // prepare the lists on the main thread - this touches the shared state of the ImGui context
+    const ImTextureID texFont = ImGui::GetIO().Fonts->TexID;
+    for (int i = 0; i < n; ++i) {
+        auto & entry = lists[i];
+        auto & list = *entry.list;
+
+        list._ResetForNewFrame();
+
+        list.Flags = panels[i].target->Flags;
+        list.PushClipRect(panels[i].clipMin, panels[i].clipMax);
+        list.PushTextureID(texFont);
+
+        list.VtxBuffer.reserve(std::max(kMinReserveVtx, entry.nVtx + entry.nVtx/2));
+        list.IdxBuffer.reserve(std::max(kMinReserveIdx, entry.nIdx + entry.nIdx/2));
+        list.CmdBuffer.reserve(std::max(kMinReserveCmd, entry.nCmd + entry.nCmd/2));
+        list._Path.reserve(kMinReservePath);
+    }
+
+    threadPool.parallelFor(0, n, 1, [&](int i0, int i1) {
+        for (int i = i0; i < i1; ++i) {
+            panels[i].call(panels[i].closure, *lists[i].list);
+        }
+    });
+
+    for (int i = 0; i < n; ++i) {
+        auto & entry = lists[i];
+        const auto & list = *entry.list;
+
+        entry.nVtx = list.VtxBuffer.Size;
+        entry.nIdx = list.IdxBuffer.Size;
+        entry.nCmd = list.CmdBuffer.Size;
+
+        // not found if the target has been reset since add()
+        const int iMarker = findMarker(*panels[i].target, i);
+        if (iMarker >= 0) {
+            spliceDrawList(*panels[i].target, iMarker, list);
+        }
+
+        // the memory of the closure is released with the frame arena
+        panels[i].destroy(panels[i].closure);
+    }
+
+    panels.clear();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "thread-pool.h"
+
+#include <imgui/imgui.h>
+#include <imgui-extra/imgui_alloc.h>
+
+#include <new>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+//
+// record the custom drawing of independent panels into separate draw lists on the thread pool
+// and merge them into the window draw lists before ImGui::Render()
+//
+// add() puts a marker command in the target list, and flush() replaces it with the recorded panel, so the panel keeps
+// its place in the z-order relative to what is drawn into the target before and after add()
+//
+// the draw functions run on worker threads, so they must only use the ImDrawList they are given -
+// no ImGui:: calls. filling a draw list only reads the shared data (font atlas, circle tessellation tables)
+// the lists are reused between frames and reserved with headroom over the last frame, so the workers rarely allocate.
+// when they do, ImGui::MemAlloc() does not touch the context - the current context is per thread and the workers
+// have none (see imconfig-vtx32.h), so those allocations are missing from IO.MetricsActiveAllocations
+// the draw functions are stored in the frame arena (see ImGui_FrameAlloc), so queueing them does not allocate either
+//
+struct ParallelDraw {
+    // queue a panel to be drawn into the target list (e.g. ImGui::GetWindowDrawList()) at the current position -
+    // the current clip rect of the target is used for the panel
+    // fn is called as fn(ImDrawList & drawList)
+    template <typename F>
+    void add(ImDrawList * target, F && fn) {
+        using T = std::decay_t<F>;
+
+        T * closure = new (ImGui_FrameAlloc(sizeof(T), alignof(T))) T(std::forward<F>(fn));
+
+        addPanel(target, closure,
+                 [](void * f, ImDrawList & drawList) { (*(T *) f)(drawList); },
+                 [](void * f) { ((T *) f)->~T(); });
+    }
+
+    // record the queued panels in parallel and merge them into their targets at the positions of add()
+    // call before ImGui::Render()
+    void flush(ThreadPool & threadPool);
+
+    bool empty() const { return panels.empty(); }
+
+private:
+    using CallFn = void (*)(void * closure, ImDrawList & drawList);
+    using DestroyFn = void (*)(void * closure);
+
+    struct Panel {
+        ImDrawList * target;
+        ImVec2 clipMin;
+        ImVec2 clipMax;
+
+        void * closure;
+        CallFn call;
+        DestroyFn destroy;
+    };
+
+    void addPanel(ImDrawList * target, void * closure, CallFn call, DestroyFn destroy);
+
+    struct PanelList {
+        std::unique_ptr<ImDrawList> list;
+
+        // sizes reached in the last frame
+        int nVtx = 0;
+        int nIdx = 0;
+        int nCmd = 0;
+    };
+
+    std::vector<Panel> panels;
+
+    // one list per panel, kept between frames
+    std::vector<PanelList> lists;
+};
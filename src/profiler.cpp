@@ -0,0 +1,269 @@
+#include "profiler.h"
+
+#include <imgui/imgui.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+
+namespace Profiler {
+
+namespace {
+
+struct Frame {
+    std::array<int64_t, Phase::Count> phases_us {};
+
+    int64_t total_us() const {
+        int64_t res = 0;
+        for (const auto & t : phases_us) res += t;
+        return res;
+    }
+};
+
+const auto kStartTime = std::chrono::steady_clock::now();
+
+const char * kPhaseNames[Phase::Count] = {
+    "events",
+    "update-pre",
+    "render",
+    "imgui-render",
+    "render-draw-data",
+    "swap",
+    "update-post",
+};
+
+const ImU32 kPhaseColors[Phase::Count] = {
+    IM_COL32(120, 120, 120, 255),
+    IM_COL32( 80, 160, 255, 255),
+    IM_COL32( 80, 220,  80, 255),
+    IM_COL32(255, 200,  40, 255),
+    IM_COL32(255, 110,  40, 255),
+    IM_COL32(220,  60, 220, 255),
+    IM_COL32( 40, 200, 200, 255),
+};
+
+struct State {
+    Frame current;
+
+    // ring buffer with the last rendered frames
+    std::array<Frame, kMaxFrames> frames;
+    int head = 0;
+    int count = 0;
+
+    const Frame & get(int i) const {
+        return frames[(head + kMaxFrames - count + i) % kMaxFrames];
+    }
+} g_state;
+
+float toMs(int64_t t_us) {
+    return 1e-3f*t_us;
+}
+
+int64_t value_us(const Frame & frame, Phase phase) {
+    return phase == Phase::Count ? frame.total_us() : frame.phases_us[phase];
+}
+
+}
+
+const char * phaseName(Phase phase) {
+    return phase == Phase::Count ? "total" : kPhaseNames[phase];
+}
+
+int64_t time_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - kStartTime).count();
+}
+
+void beginFrame() {
+    g_state.current = {};
+}
+
+void endFrame(bool commit) {
+    if (commit == false) {
+        return;
+    }
+
+    g_state.frames[g_state.head] = g_state.current;
+    g_state.head = (g_state.head + 1) % kMaxFrames;
+    g_state.count = std::min(g_state.count + 1, kMaxFrames);
+}
+
+void addTime(Phase phase, int64_t dt_us) {
+    g_state.current.phases_us[phase] += dt_us;
+}
+
+int nFrames() {
+    return g_state.count;
+}
+
+float frameTime_ms(int i, Phase phase) {
+    if (i < 0 || i >= g_state.count) {
+        return 0.0f;
+    }
+
+    return toMs(value_us(g_state.get(i), phase));
+}
+
+float percentile_ms(Phase phase, float p) {
+    const int n = g_state.count;
+    if (n == 0) {
+        return 0.0f;
+    }
+
+    std::array<int64_t, kMaxFrames> values;
+    for (int i = 0; i < n; ++i) {
+        values[i] = value_us(g_state.get(i), phase);
+    }
+
+    const int k = std::clamp((int) (0.01f*p*(n - 1) + 0.5f), 0, n - 1);
+    std::nth_element(values.begin(), values.begin() + k, values.begin() + n);
+
+    return toMs(values[k]);
+}
+
+void showOverlay() {
+    const int n = g_state.count;
+
+    ImGui::Text("Frames: %d", n);
+
+    // per-phase statistics
+    for (int p = 0; p <= Phase::Count; ++p) {
+        const auto phase = (Phase) p;
+
+        if (phase < Phase::Count) {
+            ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(kPhaseColors[phase]), "%-16s", phaseName(phase));
+        } else {
+            ImGui::Text("%-16s", phaseName(phase));
+        }
+        ImGui::SameLine();
+        ImGui::Text("last %6.3f  p50 %6.3f  p99 %6.3f ms", frameTime_ms(n - 1, phase), percentile_ms(phase, 50.0f), percentile_ms(phase, 99.0f));
+    }
+
+    auto drawList = ImGui::GetWindowDrawList();
+
+    const float kWidth = 32.0f*ImGui::GetFontSize();
+    const float kHeight = 4.0f*ImGui::GetFontSize();
+
+    // the full height of the bars corresponds to this frame time
+    const float kScale_ms = std::max(1000.0f/60.0f, percentile_ms(Phase::Count, 99.0f));
+
+    // last frame split into phases
+    {
+        const auto p0 = ImGui::GetCursorScreenPos();
+        const float h = 0.25f*kHeight;
+
+        float x = p0.x;
+        for (int p = 0; p < Phase::Count; ++p) {
+            const float w = kWidth*frameTime_ms(n - 1, (Phase) p)/kScale_ms;
+            drawList->AddRectFilled({ x, p0.y }, { x + w, p0.y + h }, kPhaseColors[p]);
+            x += w;
+        }
+
+        ImGui::Dummy({ kWidth, h });
+    }
+
+    // history of the frame times
+    {
+        const auto p0 = ImGui::GetCursorScreenPos();
+        const int nBars = std::min(n, (int) (kWidth/2.0f));
+
+        drawList->AddRectFilled(p0, { p0.x + kWidth, p0.y + kHeight }, IM_COL32(0, 0, 0, 128));
+
+        for (int i = 0; i < nBars; ++i) {
+            const int idx = n - nBars + i;
+            const float x0 = p0.x + kWidth*i/nBars;
+            const float x1 = p0.x + kWidth*(i + 1)/nBars;
+
+            float y = p0.y + kHeight;
+            for (int p = 0; p < Phase::Count; ++p) {
+                const float h = kHeight*frameTime_ms(idx, (Phase) p)/kScale_ms;
+                drawList->AddRectFilled({ x0, std::max(p0.y, y - h) }, { x1, y }, kPhaseColors[p]);
+                y -= h;
+            }
+        }
+
+        ImGui::Dummy({ kWidth, kHeight });
+    }
+}
+
+std::string toCSV() {
+    std::string res = "frame";
+    for (int p = 0; p <= Phase::Count; ++p) {
+        res += ",";
+        res += phaseName((Phase) p);
+    }
+    res += "\n";
+
+    char buf[32];
+    for (int i = 0; i < g_state.count; ++i) {
+        res += std::to_string(i);
+        for (int p = 0; p <= Phase::Count; ++p) {
+            snprintf(buf, sizeof(buf), ",%.3f", frameTime_ms(i, (Phase) p));
+            res += buf;
+        }
+        res += "\n";
+    }
+
+    return res;
+}
+
+std::string toJSON() {
+    char buf[64];
+
+    std::string res = "{\n  \"phases\": [";
+    for (int p = 0; p <= Phase::Count; ++p) {
+        res += p == 0 ? "\"" : ", \"";
+        res += phaseName((Phase) p);
+        res += "\"";
+    }
+    res += "],\n";
+
+    for (const float pct : { 50.0f, 99.0f }) {
+        snprintf(buf, sizeof(buf), "  \"p%d\": [", (int) pct);
+        res += buf;
+        for (int p = 0; p <= Phase::Count; ++p) {
+            snprintf(buf, sizeof(buf), "%s%.3f", p == 0 ? "" : ", ", percentile_ms((Phase) p, pct));
+            res += buf;
+        }
+        res += "],\n";
+    }
+
+    res += "  \"frames\": [\n";
+    for (int i = 0; i < g_state.count; ++i) {
+        res += "    [";
+        for (int p = 0; p <= Phase::Count; ++p) {
+            snprintf(buf, sizeof(buf), "%s%.3f", p == 0 ? "" : ", ", frameTime_ms(i, (Phase) p));
+            res += buf;
+        }
+        res += i + 1 < g_state.count ? "],\n" : "]\n";
+    }
+    res += "  ]\n}\n";
+
+    return res;
+}
+
+bool dump(const std::string & filename) {
+    const bool isJSON = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+
+    std::ofstream fout(filename);
+    if (fout.good() == false) {
+        fprintf(stderr, "Error: failed to open '%s' for writing\n", filename.c_str());
+        return false;
+    }
+
+    fout << (isJSON ? toJSON() : toCSV());
+
+    printf("Profiler: dumped %d frames to '%s'\n", g_state.count, filename.c_str());
+
+    return true;
+}
+
+Sentry::Sentry(Phase phase) : phase(phase), tStart_us(time_us()) {
+}
+
+Sentry::~Sentry() {
+    addTime(phase, time_us() - tStart_us);
+}
+
+}
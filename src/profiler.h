@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <cstdint> // int64_t
+
+//
+// lightweight frame-time profiler
+//
+// each iteration of the main loop is split into phases that are timed with the RAII Profiler::Sentry
+// the timings of the last kMaxFrames rendered frames are kept in a ring buffer
+//
+
+namespace Profiler {
+
+enum Phase : int {
+    Events = 0,     // ImGui_ProcessEvent
+    UpdatePre,      // StateCore::updatePre
+    Render,         // StateCore::render
+    ImGuiRender,    // ImGui::Render
+    RenderDrawData, // ImGui_RenderDrawData
+    Swap,           // SDL_GL_SwapWindow
+    UpdatePost,     // StateCore::updatePost
+
+    Count,
+};
+
+// number of frames kept in the ring buffer
+constexpr int kMaxFrames = 512;
+
+const char * phaseName(Phase phase);
+
+// time in microseconds since the start of the program
+int64_t time_us();
+
+// call at the start of each iteration of the main loop
+void beginFrame();
+
+// call at the end of each iteration of the main loop
+// only frames that were actually rendered should be committed to the ring buffer
+void endFrame(bool commit);
+
+// add time to the given phase of the current frame
+void addTime(Phase phase, int64_t dt_us);
+
+// number of frames currently in the ring buffer
+int nFrames();
+
+// time in ms spent in the given phase during the i-th frame (0 is the oldest)
+// use Phase::Count to get the total frame time
+float frameTime_ms(int i, Phase phase);
+
+// p-th percentile (0 - 100) in ms over the frames in the ring buffer
+// use Phase::Count to get the percentile of the total frame time
+float percentile_ms(Phase phase, float p);
+
+// draw the profiler overlay inside the current ImGui window
+void showOverlay();
+
+// serialize the contents of the ring buffer
+std::string toCSV();
+std::string toJSON();
+
+// dump the ring buffer to a file - the format is chosen based on the extension (.csv or .json)
+bool dump(const std::string & filename);
+
+// RAII-based phase timing
+struct Sentry {
+    Sentry(Phase phase);
+    ~Sentry();
+
+    const Phase phase;
+    const int64_t tStart_us;
+};
+
+}
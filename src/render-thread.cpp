@@ -0,0 +1,214 @@
+#include "render-thread.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifndef __EMSCRIPTEN__
+
+#include <imgui-extra/imgui_impl.h>
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+namespace {
+
+// copy the contents without releasing the capacity of dst - ImVector::operator= frees the old buffer
+template <typename T>
+void copyVector(ImVector<T> & dst, const ImVector<T> & src) {
+    dst.resize(src.Size);
+    if (src.Size > 0) {
+        memcpy(dst.Data, src.Data, (size_t) src.Size*sizeof(T));
+    }
+}
+
+}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+bool RenderThread::start(SDL_Window * window, void * context) {
+    stop();
+
+    this->window = window;
+    this->context = context;
+    this->imguiContext = ImGui::GetCurrentContext();
+
+    // a GL context can be current on a single thread at a time
+    if (SDL_GL_MakeCurrent(window, nullptr) != 0) {
+        fprintf(stderr, "Error: failed to release the GL context. Reason: %s\n", SDL_GetError());
+        return false;
+    }
+
+    isStopping = false;
+    hasPending = false;
+    job = nullptr;
+
+    worker = std::thread([this]() { run(); });
+
+    printf("Render thread started\n");
+
+    return true;
+}
+
+void RenderThread::stop() {
+    if (worker.joinable() == false) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    cv.notify_all();
+
+    worker.join();
+
+    SDL_GL_MakeCurrent(window, context);
+}
+
+void RenderThread::submit(const ImDrawData * drawData, int displayW, int displayH) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // the previous frame has not been picked up yet
+    cv.wait(lock, [this]() { return hasPending == false; });
+
+    // iRender is the frame that the render thread is currently drawing (if any)
+    auto & frame = frames[iRender ^ 1];
+
+    const int n = drawData->CmdListsCount;
+    while ((int) frame.lists.size() < n) {
+        frame.lists.emplace_back(new ImDrawList(ImGui::GetDrawListSharedData()));
+    }
+    frame.listPtrs.resize(n);
+
+    for (int i = 0; i < n; ++i) {
+        const ImDrawList * src = drawData->CmdLists[i];
+        ImDrawList * dst = frame.lists[i].get();
+
+        copyVector(dst->CmdBuffer, src->CmdBuffer);
+        dst->CmdBuffer.reserve(ImGui_GetRenderCmdCapacity(src->CmdBuffer.Size));
+        copyVector(dst->IdxBuffer, src->IdxBuffer);
+        copyVector(dst->VtxBuffer, src->VtxBuffer);
+        dst->Flags = src->Flags;
+
+        frame.listPtrs[i] = dst;
+    }
+
+    frame.drawData.Valid            = drawData->Valid;
+    frame.drawData.CmdListsCount    = n;
+    frame.drawData.TotalIdxCount    = drawData->TotalIdxCount;
+    frame.drawData.TotalVtxCount    = drawData->TotalVtxCount;
+    frame.drawData.CmdLists         = frame.listPtrs.data();
+    frame.drawData.DisplayPos       = drawData->DisplayPos;
+    frame.drawData.DisplaySize      = drawData->DisplaySize;
+    frame.drawData.FramebufferScale = drawData->FramebufferScale;
+
+    frame.displayW = displayW;
+    frame.displayH = displayH;
+
+    hasPending = true;
+
+    lock.unlock();
+    cv.notify_all();
+}
+
+void RenderThread::invoke(const std::function<void()> & fn) {
+    if (worker.joinable() == false) {
+        fn();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // the jobs run after the pending frame
+    cv.wait(lock, [this]() { return job == nullptr; });
+    job = &fn;
+    cv.notify_all();
+
+    cv.wait(lock, [this, &fn]() { return job != &fn; });
+}
+
+void RenderThread::run() {
+    if (SDL_GL_MakeCurrent(window, context) != 0) {
+        fprintf(stderr, "Error: failed to make the GL context current on the render thread. Reason: %s\n", SDL_GetError());
+    }
+
+    // the backend reads the IO of the context - the render thread must not allocate through ImGui::MemAlloc() while
+    // the main thread builds the next frame, so the buffers it modifies are reserved in submit()
+    ImGui::SetCurrentContext(imguiContext);
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        cv.wait(lock, [this]() { return isStopping || hasPending || job; });
+
+        if (hasPending) {
+            iRender ^= 1;
+            hasPending = false;
+
+            // the main thread can start filling the other frame
+            lock.unlock();
+            cv.notify_all();
+
+            render(frames[iRender]);
+
+            lock.lock();
+            continue;
+        }
+
+        if (job) {
+            (*job)();
+            job = nullptr;
+            cv.notify_all();
+            continue;
+        }
+
+        if (isStopping) {
+            break;
+        }
+    }
+
+    lock.unlock();
+
+    glFinish();
+    SDL_GL_MakeCurrent(window, nullptr);
+}
+
+void RenderThread::render(Frame & frame) {
+    glViewport(0, 0, frame.displayW, frame.displayH);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    ImGui_RenderDrawData(&frame.drawData);
+
+    SDL_GL_SwapWindow(window);
+}
+
+#else
+
+RenderThread::~RenderThread() {
+}
+
+bool RenderThread::start(SDL_Window * , void * ) {
+    fprintf(stderr, "Error: render thread is not supported on this platform\n");
+    return false;
+}
+
+void RenderThread::stop() {
+}
+
+void RenderThread::submit(const ImDrawData * , int , int ) {
+}
+
+void RenderThread::invoke(const std::function<void()> & fn) {
+    fn();
+}
+
+void RenderThread::run() {
+}
+
+void RenderThread::render(Frame & ) {
+}
+
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <imgui/imgui.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+struct SDL_Window;
+
+//
+// native render thread - owns the GL context and submits the frames built on the main thread
+//
+// submit() deep-copies the draw data of the finished frame, so the main thread can process the input and build
+// the next frame while the previous one is being rendered and swapped
+// there is at most one frame waiting for the render thread - if the GPU falls behind, submit() blocks
+//
+// not available on the web
+//
+struct RenderThread {
+    ~RenderThread();
+
+    // the GL context is released from the calling thread and made current on the render thread
+    bool start(SDL_Window * window, void * context);
+
+    // waits for the pending frame and makes the GL context current on the calling thread again
+    void stop();
+
+    // copy the draw data and hand it over to the render thread
+    void submit(const ImDrawData * drawData, int displayW, int displayH);
+
+    // run a function on the render thread and wait for it to finish - used for GL work outside of the frames,
+    // like uploading a new font texture
+    void invoke(const std::function<void()> & fn);
+
+    bool isRunning() const { return worker.joinable(); }
+
+private:
+    struct Frame {
+        ImDrawData drawData;
+
+        // the lists are reused between frames to avoid reallocating the buffers
+        std::vector<std::unique_ptr<ImDrawList>> lists;
+        std::vector<ImDrawList *> listPtrs;
+
+        int displayW = 0;
+        int displayH = 0;
+    };
+
+    void run();
+    void render(Frame & frame);
+
+    SDL_Window * window = nullptr;
+    void * context = nullptr;
+
+    // the current ImGui context is per thread (see imconfig-vtx32.h) - the render thread uses the one of start()
+    ImGuiContext * imguiContext = nullptr;
+
+    // double-buffered - the main thread fills one frame while the render thread draws the other
+    Frame frames[2];
+    int iRender = 0;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    bool isStopping = false;
+    bool hasPending = false;
+    const std::function<void()> * job = nullptr;
+
+    std::thread worker;
+};
@@ -0,0 +1,108 @@
+#include "state-backend.h"
+
+#include "profiler.h"
+
+#include <cmath>
+#include <cstdio>
+
+bool StateBackend::init(ThreadPool & threadPool, std::function<void()> onPublish) {
+    deinit();
+
+    this->threadPool = &threadPool;
+    this->onPublish = std::move(onPublish);
+
+#ifdef GGWEB_HAS_THREADS
+    isRunning = true;
+    worker = std::thread([this]() { run(); });
+
+    printf("Started the backend thread\n");
+#else
+    printf("No thread support - the backend runs on the main thread\n");
+#endif
+
+    return true;
+}
+
+void StateBackend::deinit() {
+    if (worker.joinable()) {
+        isRunning = false;
+
+        ++nPending;
+        nPending.notify_one();
+
+        worker.join();
+    }
+}
+
+void StateBackend::submit(const std::vector<float> & samples) {
+    auto & dst = input.back();
+    dst.id = ++nSubmitted;
+    dst.samples = samples;
+
+    if (isThreaded() == false) {
+        process(dst, output.back());
+        output.publish();
+        return;
+    }
+
+    input.publish();
+
+    ++nPending;
+    nPending.notify_one();
+}
+
+bool StateBackend::update() {
+    return output.update();
+}
+
+void StateBackend::run() {
+    uint32_t nSeen = 0;
+
+    while (true) {
+        nPending.wait(nSeen);
+        nSeen = nPending.load();
+
+        if (isRunning == false) {
+            break;
+        }
+
+        // multiple submits may have been coalesced into one
+        if (input.update() == false) {
+            continue;
+        }
+
+        process(input.front(), output.back());
+        output.publish();
+
+        if (onPublish) {
+            onPublish();
+        }
+    }
+}
+
+void StateBackend::process(const BackendInput & input, BackendSnapshot & result) {
+    const int64_t tStart_us = Profiler::time_us();
+
+    const auto & x = input.samples;
+    const int n = (int) x.size();
+
+    // naive DFT - stands for any expensive computation
+    auto & spectrum = result.spectrum;
+    spectrum.resize(n/2);
+
+    threadPool->parallelFor(0, n/2, 64, [&](int k0, int k1) {
+        for (int k = k0; k < k1; ++k) {
+            float re = 0.0f;
+            float im = 0.0f;
+            for (int i = 0; i < n; ++i) {
+                const float phi = 2.0f*float(M_PI)*k*i/n;
+                re += x[i]*std::cos(phi);
+                im -= x[i]*std::sin(phi);
+            }
+            spectrum[k] = std::sqrt(re*re + im*im)/n;
+        }
+    });
+
+    result.id = input.id;
+    result.tCompute_ms = 1e-3f*(Profiler::time_us() - tStart_us);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "triple-buffer.h"
+#include "thread-pool.h"
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+// input of the backend, submitted by the UI
+struct BackendInput {
+    uint64_t id = 0;
+
+    std::vector<float> samples;
+};
+
+// result of the backend computation - immutable once published
+struct BackendSnapshot {
+    uint64_t id = 0; // id of the input that produced this snapshot
+
+    float tCompute_ms = 0.0f;
+
+    // magnitude spectrum of the samples
+    std::vector<float> spectrum;
+};
+
+//
+// the heavy part of the application logic, running on a separate thread
+//
+// the UI and the backend exchange data only through triple buffers, so the UI never waits for the backend
+// and the frame rate does not depend on how long the computation takes
+//
+// without threads (web build without SharedArrayBuffer support) the work is done inline in submit()
+//
+struct StateBackend {
+    // onPublish is called from the backend thread after a new snapshot has been published
+    // the computation is split across the threads of the pool
+    bool init(ThreadPool & threadPool, std::function<void()> onPublish);
+    void deinit();
+
+    //
+    // UI thread
+    //
+
+    // start processing new samples - the previous input is dropped if it has not been picked up yet
+    void submit(const std::vector<float> & samples);
+
+    // pick up the latest snapshot - returns true if there is a new one
+    bool update();
+
+    const BackendSnapshot & snapshot() const { return output.front(); }
+
+    bool isThreaded() const { return worker.joinable(); }
+
+private:
+    void run();
+
+    // the actual work
+    void process(const BackendInput & input, BackendSnapshot & result);
+
+    ThreadPool * threadPool = nullptr;
+
+    TripleBuffer<BackendInput> input;
+    TripleBuffer<BackendSnapshot> output;
+
+    uint64_t nSubmitted = 0;
+
+    std::function<void()> onPublish;
+
+    std::thread worker;
+    std::atomic<bool> isRunning { false };
+
+    // incremented on each submit - the backend thread waits on it
+    std::atomic<uint32_t> nPending { 0 };
+};
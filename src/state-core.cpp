@@ -1,13 +1,28 @@
 #include "state-core.h"
 
+#include "profiler.h"
 #include "icons-font-awesome.h"
 
+#include <imgui-extra/imgui_impl.h>
+#include <imgui-extra/imgui_alloc.h>
+#include <imgui-extra/imgui_draw_simd.h>
+
 #include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <algorithm>
 
 namespace {
 
 using TColor = uint32_t;
 
+// size of the ring buffers for passing data between the JS layer and the app
+const size_t kDataInSize  = 4*1024*1024;
+const size_t kDataOutSize = 16*1024*1024;
+
+// U+F0E4 - the tachometer of the bundled Font Awesome 4 font (icons-font-awesome.h lists the Font Awesome 5 names)
+#define ICON_FA4_TACHOMETER "\xEF\x83\xA4"
+
 }
 
 //
@@ -18,12 +33,31 @@ void Rendering::init() {
     T = ImGui::GetTime();
     isAnimating = false;
     wSize = ImGui::GetContentRegionAvail();
+    nextUpdate = -1.0f;
+
+    timeline.update(T);
+}
+
+void Rendering::commit() {
+    const float dt = timeline.nextUpdate();
+    if (dt == 0.0f) {
+        isAnimating = true;
+    } else if (dt > 0.0f) {
+        scheduleUpdate(dt);
+    }
 }
 
 void Rendering::animation(float i) {
     isAnimating |= (i != 0.0f && i < 1.0f);
 }
 
+void Rendering::scheduleUpdate(float dt) {
+    dt = std::max(0.0f, dt);
+    if (nextUpdate < 0.0f || dt < nextUpdate) {
+        nextUpdate = dt;
+    }
+}
+
 //
 // StateCore
 //
@@ -31,8 +65,42 @@ void Rendering::animation(float i) {
 void StateCore::onWindowResize() {
 }
 
-void StateCore::updateDataDummy() {
-    dataDummy = "foo bar";
+void StateCore::pushDataDummy() {
+    dataOut.push("foo bar");
+
+    float values[32];
+    for (int i = 0; i < 32; ++i) {
+        values[i] = std::sin(0.2f*i + rendering.T);
+    }
+    dataOut.push((uint32_t) MessageType::Float32, values, sizeof(values));
+}
+
+void StateCore::processDataIn() {
+    MessageHeader header;
+    while (const auto data = dataIn.peek(header)) {
+        switch ((MessageType) header.type) {
+            case MessageType::Text:
+                {
+                    printf("Received some data from the JS layer: %.*s\n", (int) header.size, (const char *) data);
+                } break;
+            case MessageType::Float32:
+                {
+                    dataPlot.resize(header.size/sizeof(float));
+                    memcpy(dataPlot.data(), data, dataPlot.size()*sizeof(float));
+
+                    backend.submit(dataPlot);
+                } break;
+            default:
+                {
+                    printf("Received message of type %u with %u bytes from the JS layer\n", header.type, header.size);
+                } break;
+        }
+
+        dataIn.pop();
+
+        // make sure that the new data is rendered
+        rendering.nUpdates = std::max(rendering.nUpdates, 1);
+    }
 }
 
 //
@@ -44,6 +112,18 @@ void StateCore::init(float fontScale) {
 
     this->fontScale = fontScale;
 
+    dataIn.init(kDataInSize);
+    dataOut.init(kDataOutSize);
+
+    const auto onDone = [this]() {
+        if (wakeUp) {
+            wakeUp();
+        }
+    };
+
+    threadPool.init(0, onDone);
+    backend.init(threadPool, onDone);
+
     printf("Initialized the application state\n");
     isInitialized = true;
 }
@@ -52,6 +132,7 @@ void StateCore::render() {
     // shortcuts
     const auto & T     = rendering.T;
     const auto & wSize = rendering.wSize;
+    auto & timeline    = rendering.timeline;
 
     if (rendering.isFirstFrame) {
         ImGui::SetStyle();
@@ -75,23 +156,34 @@ void StateCore::render() {
 
         auto drawList = ImGui::GetWindowDrawList();
 
+        // the circle moves at the full framerate while it is visible or fading out
+        const bool isFading = timeline.isActive(idCircleFade);
+        if (showCircle || isFading) {
+            if (timeline.isActive(idCircle) == false) {
+                idCircle = timeline.loop();
+            }
+        } else {
+            timeline.stop(idCircle);
+        }
+
         // draw a moving circle
-        if (showCircle) {
+        if (showCircle || isFading) {
+            const float alpha = showCircle ? timeline.value(idCircleFade) : 1.0f - timeline.value(idCircleFade);
+
             const ImVec2 pos = {
                 (0.5f + 0.25f*std::sin(2.0f*T       ))*wSize.x,
                 (0.5f + 0.35f*std::sin(3.0f*T + 1.0f))*wSize.y,
             };
 
             const float radius = 4.0f + 16.0f*std::fabs(std::sin(T));
-            const TColor color = ImGui::ColorConvertFloat4ToU32({ 0.0f, 1.0f, 0.1f, 0.8f, });
-
-            drawList->AddCircleFilled(pos, radius, color);
+            const TColor color = ImGui::ColorConvertFloat4ToU32({ 0.0f, 1.0f, 0.1f, 0.8f*alpha, });
 
-            rendering.isAnimating = true;
+            const ImGuiCircle circle = { pos, radius, color, };
+            ImGui_AddCirclesFilled(drawList, &circle, 1);
         }
 
-        // animation indicator in the lower-left corner of the screen
-        if (rendering.isAnimating) {
+        // indicator in the lower-left corner of the screen while rendering at the full framerate
+        if (timeline.nextUpdate() == 0.0f) {
             drawList->AddRectFilled({ 0.0f, wSize.y - 6.0f, }, { 6.0f, wSize.y, }, ImGui::ColorConvertFloat4ToU32({ 1.0f, 1.0f, 0.0f, 1.0f, }));
         }
     }
@@ -114,11 +206,41 @@ void StateCore::render() {
             ImGui::Text("Mouse down duration: %g\n", ImGui::GetIO().MouseDownDuration[0]);
             ImGui::Text("FA ICON COG: " ICON_FA_COG);
 
-            ImGui::Checkbox("Show circle", &showCircle);
+            if (ImGui::Checkbox("Show circle", &showCircle)) {
+                timeline.stop(idCircleFade);
+                idCircleFade = timeline.tween(0.25f, 0.0f, Timeline::smooth);
+            }
+
+            // blinks at 2 Hz - only 4 frames per second are rendered for it
+            if (ImGui::Checkbox("Blinking indicator", &showBlink)) {
+                timeline.stop(idBlink);
+                if (showBlink) {
+                    idBlink = timeline.loop(4.0f);
+                }
+            }
+            if (showBlink) {
+                ImGui::SameLine();
+                ImGui::TextColored({ 1.0f, 0.2f, 0.2f, timeline.ticks(idBlink) % 2 == 0 ? 1.0f : 0.0f, }, "REC");
+            }
+
+            // the icon is not in the initial glyph set - request it before drawing, it is rasterized for the next frame
+            if (ImGui::RequestGlyphs(ICON_FA4_TACHOMETER)) {
+                rendering.nUpdates = std::max(rendering.nUpdates, 1);
+            }
+            ImGui::Checkbox(ICON_FA4_TACHOMETER " Show profiler", &showProfiler);
+
+            if (dataPlot.empty() == false) {
+                ImGui::PlotLines("Data from JS", dataPlot.data(), (int) dataPlot.size(), 0, nullptr, FLT_MAX, FLT_MAX, { 200.0f, 48.0f });
+            }
+
+            if (const auto & snapshot = backend.snapshot(); snapshot.spectrum.empty() == false) {
+                ImGui::PlotHistogram("Spectrum", snapshot.spectrum.data(), (int) snapshot.spectrum.size(), 0, nullptr, 0.0f, FLT_MAX, { 200.0f, 48.0f });
+                ImGui::Text("Backend: input %llu, %.3f ms%s", (unsigned long long) snapshot.id, snapshot.tCompute_ms, backend.isThreaded() ? "" : " (main thread)");
+            }
 
             ImGui::Button("Push data to JS", { 200.0f, 24.0f });
             if (ImGui::IsItemHovered(ImGuiHoveredFlags_None) && ImGui::IsMouseJustPressed(0)) {
-                updateDataDummy();
+                pushDataDummy();
             }
 
             ImGui::Button("Copy to clipboard", { 200.0f, 24.0f });
@@ -135,12 +257,62 @@ void StateCore::render() {
         ImGui::End();
     }
 
+    // profiler overlay in the upper-right corner of the screen
+    if (showProfiler) {
+        ImGui::SetNextWindowPos({ ImGui::GetIO().DisplaySize.x - 8.0f, 8.0f }, ImGuiCond_Always, { 1.0f, 0.0f });
+        ImGui::SetNextWindowBgAlpha(0.75f);
+        ImGui::Begin("profiler", NULL,
+                     ImGuiWindowFlags_NoNav |
+                     ImGuiWindowFlags_NoInputs |
+                     ImGuiWindowFlags_NoDecoration |
+                     ImGuiWindowFlags_NoFocusOnAppearing |
+                     ImGuiWindowFlags_AlwaysAutoResize);
+
+        {
+            ImGui::FontSentry sentry(0, 1.0f/fontScale);
+
+            Profiler::showOverlay();
+            ImGui::Text("Unchanged frames skipped: %llu", (unsigned long long) ImGui::GetSkippedFrames());
+
+            const auto allocStats = ImGui_GetAllocStats();
+            ImGui::Text("Allocs/frame: %lld (%.1f KB), malloc: %lld, arena: %.1f KB",
+                        (long long) allocStats.nAllocs, allocStats.nBytes/1024.0f, (long long) allocStats.nAllocsHeap, allocStats.nBytesFrameArena/1024.0f);
+            ImGui::Text("ImGui heap: %.1f KB in use, %.1f KB reserved", allocStats.nBytesInUse/1024.0f, allocStats.nBytesReserved/1024.0f);
+
+            const auto renderStats = ImGui_GetRenderStats();
+            ImGui::Text("Draw calls: %d (%d commands), state changes: %d", renderStats.nDrawCalls, renderStats.nCmds, renderStats.nStateChanges);
+            if (renderStats.isStreaming) {
+                ImGui::Text("Uploaded: %.1f KB (%d lists, %d unchanged) - %s", renderStats.nBytesUploaded/1024.0f,
+                            renderStats.nListsUploaded, renderStats.nListsSkipped, renderStats.isPersistent ? "mapped" : "sub-data");
+                ImGui::Text("16-bit indices: %d of %d commands", renderStats.nCmdsIdx16, renderStats.nCmdsIdx16 + renderStats.nCmdsIdx32);
+            }
+            ImGui::Text("Vertex generation: %s", ImGui_GetSimdLevelName(ImGui_GetSimdLevel()));
+        }
+
+        ImGui::End();
+    }
+
     ImGui::End();
+
+    // the panels have to be merged while their target draw lists are still being built
+    parallelDraw.flush(threadPool);
+
+    rendering.commit();
 }
 
 bool StateCore::updatePre() {
     //const float T = ImGui::GetTime();
 
+    processDataIn();
+
+    // new results from the backend and the thread pool
+    const bool hasNewSnapshot = backend.update();
+    const bool hasCompleted = threadPool.processCompleted() > 0;
+    const bool hasAssets = assets.update() > 0;
+    if (hasNewSnapshot || hasCompleted || hasAssets) {
+        rendering.nUpdates = std::max(rendering.nUpdates, 1);
+    }
+
 #ifndef EMSCRIPTEN
     if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Escape))) {
         printf("Escape pressed - exiting\n");
@@ -156,4 +328,7 @@ bool StateCore::updatePost() {
 }
 
 void StateCore::deinitMain() {
+    backend.deinit();
+    threadPool.deinit();
+    threadPool.processCompleted();
 }
@@ -1,10 +1,17 @@
 #pragma once
 
 #include "common.h"
+#include "data-channel.h"
+#include "state-backend.h"
+#include "parallel-draw.h"
+#include "timeline.h"
+#include "assets.h"
 
 #include <imgui/imgui.h>
 
 #include <string>
+#include <vector>
+#include <functional>
 
 // helper struct to manage the rendering state
 struct Rendering {
@@ -15,10 +22,22 @@ struct Rendering {
     int nUpdates = 60;
     bool isFirstFrame = true;
 
+    // delay in seconds after which a new frame has to be rendered, even if there are no input events
+    // negative value means that there is no scheduled update
+    float nextUpdate = -1.0f;
+
+    // animations with their update rates - converted to frame requests by commit()
+    Timeline timeline;
+
     // call this at the start of each frame to initialize helper variables
     void init();
 
+    // call this at the end of each frame - the animations that need every frame set isAnimating,
+    // the slower ones schedule the next update
+    void commit();
+
     // when there is an active animation, call this method to disable any framerate throttling that may occur
+    // prefer the timeline, which also supports animations that do not need the full framerate
     // the argument i is an interpolation factor of the animation
     //  - if it is within (0, 1) then the animation is in progress
     //  - if it is >= 1 then the animation has finished
@@ -26,13 +45,18 @@ struct Rendering {
     //  - if it is == 0 then the animation is disabled
     //
     void animation(float i);
+
+    // request a new frame to be rendered after dt seconds
+    // use this for timers and slow animations that do not need the full framerate
+    // when multiple updates are scheduled during a frame, the earliest one is used
+    void scheduleUpdate(float dt);
 };
 
 //
 // the main application logic is implemented in this class
 //
-// ideally, this can be separated in 2 classes: backend and frontend
-// here, for simplicity, we have both in one
+// this is the frontend - it owns the UI state and runs on the main thread
+// expensive computations are offloaded to the backend (see StateBackend), which publishes its results as snapshots
 //
 struct StateCore {
     bool isInitialized = false;
@@ -41,12 +65,39 @@ struct StateCore {
     // rendering
     Rendering rendering;
 
+    // called from other threads to request a new frame - set by the platform layer before init()
+    std::function<void()> wakeUp;
+
+    // worker threads for parallel work - started in init() and drained in deinitMain()
+    // tasks with completion callbacks wake up the main loop, the callbacks are called in updatePre()
+    ThreadPool threadPool;
+
+    // custom drawing of independent panels, recorded on the thread pool - flushed at the end of render()
+    ParallelDraw parallelDraw;
+
+    // backend
+    StateBackend backend;
+
+    // files loaded in the background - delivered in updatePre()
+    Assets assets;
+
     // JS interface
-    std::string dataDummy;
+    DataChannel dataIn;  // messages from the JS layer, processed in updatePre()
+    DataChannel dataOut; // messages for the JS layer, pushed to it at the end of each frame
     std::string dataClipboard;
     std::string dataURL;
 
     bool showCircle = true;
+    bool showBlink = false;
+    bool showProfiler = false;
+
+    // animations
+    Timeline::Id idCircle = 0;
+    Timeline::Id idCircleFade = 0;
+    Timeline::Id idBlink = 0;
+
+    // last array of floats received from the JS layer
+    std::vector<float> dataPlot;
 
     //
     // helper methods
@@ -55,8 +106,11 @@ struct StateCore {
     // add any logic that should happen upon window resize
     void onWindowResize();
 
-    // update the dataDummy member - to be consumed by the JS layer
-    void updateDataDummy();
+    // push some dummy data to the JS layer
+    void pushDataDummy();
+
+    // handle the messages received from the JS layer
+    void processDataIn();
 
     //
     // UI methods
@@ -1,9 +1,51 @@
 #include "state-sdl.h"
 
+#include "assets.h"
+#include "profiler.h"
+
 #include <imgui/imgui.h>
 #include <imgui-extra/imgui_impl.h>
 
 #include <SDL.h>
+#include <SDL_opengl.h>
+
+namespace {
+
+#ifndef __EMSCRIPTEN__
+
+// the framebuffer functions are not part of OpenGL 1.1, so we load them at runtime
+struct GLFramebufferFuncs {
+    PFNGLGENFRAMEBUFFERSPROC         genFramebuffers         = nullptr;
+    PFNGLBINDFRAMEBUFFERPROC         bindFramebuffer         = nullptr;
+    PFNGLDELETEFRAMEBUFFERSPROC      deleteFramebuffers      = nullptr;
+    PFNGLGENRENDERBUFFERSPROC        genRenderbuffers        = nullptr;
+    PFNGLBINDRENDERBUFFERPROC        bindRenderbuffer        = nullptr;
+    PFNGLDELETERENDERBUFFERSPROC     deleteRenderbuffers     = nullptr;
+    PFNGLRENDERBUFFERSTORAGEPROC     renderbufferStorage     = nullptr;
+    PFNGLFRAMEBUFFERRENDERBUFFERPROC framebufferRenderbuffer = nullptr;
+    PFNGLCHECKFRAMEBUFFERSTATUSPROC  checkFramebufferStatus  = nullptr;
+
+    bool load() {
+        genFramebuffers         = (PFNGLGENFRAMEBUFFERSPROC)         SDL_GL_GetProcAddress("glGenFramebuffers");
+        bindFramebuffer         = (PFNGLBINDFRAMEBUFFERPROC)         SDL_GL_GetProcAddress("glBindFramebuffer");
+        deleteFramebuffers      = (PFNGLDELETEFRAMEBUFFERSPROC)      SDL_GL_GetProcAddress("glDeleteFramebuffers");
+        genRenderbuffers        = (PFNGLGENRENDERBUFFERSPROC)        SDL_GL_GetProcAddress("glGenRenderbuffers");
+        bindRenderbuffer        = (PFNGLBINDRENDERBUFFERPROC)        SDL_GL_GetProcAddress("glBindRenderbuffer");
+        deleteRenderbuffers     = (PFNGLDELETERENDERBUFFERSPROC)     SDL_GL_GetProcAddress("glDeleteRenderbuffers");
+        renderbufferStorage     = (PFNGLRENDERBUFFERSTORAGEPROC)     SDL_GL_GetProcAddress("glRenderbufferStorage");
+        framebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC) SDL_GL_GetProcAddress("glFramebufferRenderbuffer");
+        checkFramebufferStatus  = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)  SDL_GL_GetProcAddress("glCheckFramebufferStatus");
+
+        return
+            genFramebuffers && bindFramebuffer && deleteFramebuffers &&
+            genRenderbuffers && bindRenderbuffer && deleteRenderbuffers &&
+            renderbufferStorage && framebufferRenderbuffer && checkFramebufferStatus;
+    }
+} g_gl;
+
+#endif
+
+}
 
 bool StateSDL::initWindow(const char * windowTitle) {
     ImGui_PreInit();
@@ -16,7 +58,8 @@ bool StateSDL::initWindow(const char * windowTitle) {
         SDL_CreateWindowAndRenderer(windowX, windowY, SDL_WINDOW_OPENGL | SDL_WINDOW_ALLOW_HIGHDPI | SDL_RENDERER_PRESENTVSYNC, &window, &renderer);
     }
 #else
-    window = SDL_CreateWindow(windowTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowX, windowY, SDL_WINDOW_OPENGL | SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_RESIZABLE);
+    window = SDL_CreateWindow(windowTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowX, windowY, SDL_WINDOW_OPENGL | SDL_WINDOW_ALLOW_HIGHDPI |
+                              (isHeadless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_RESIZABLE));
 #endif
     if (window == nullptr) {
         fprintf(stderr, "Error: failed to create SDL error. Reason: %s\n", SDL_GetError());
@@ -30,32 +73,103 @@ bool StateSDL::initWindow(const char * windowTitle) {
     }
 
     SDL_GL_MakeCurrent(window, context);
-    SDL_GL_SetSwapInterval(1); // Enable vsyn
+    SDL_GL_SetSwapInterval(isHeadless ? 0 : 1); // Enable vsyn
+
+#ifndef __EMSCRIPTEN__
+    // the default framebuffer of a hidden window is not guaranteed to be rendered, so use an offscreen one
+    if (isHeadless) {
+        if (g_gl.load() == false) {
+            fprintf(stderr, "Error: failed to load the OpenGL framebuffer functions\n");
+            return false;
+        }
+
+        int width = 0;
+        int height = 0;
+        SDL_GL_GetDrawableSize(window, &width, &height);
+
+        g_gl.genRenderbuffers(1, &rbo);
+        g_gl.bindRenderbuffer(GL_RENDERBUFFER, rbo);
+        g_gl.renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+        g_gl.genFramebuffers(1, &fbo);
+        g_gl.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+        g_gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rbo);
+
+        if (g_gl.checkFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            fprintf(stderr, "Error: offscreen framebuffer is incomplete\n");
+            return false;
+        }
+
+        printf("Rendering headless into a %dx%d offscreen framebuffer\n", width, height);
+    }
+#endif
 
     return true;
 }
 
-bool StateSDL::initImGui(float fontScale, const std::vector<ImGui::FontInfo> & fonts) {
+bool StateSDL::initImGui(float fontScale, const std::vector<ImGui::FontInfo> & fonts, Assets & assets) {
     ImGui_Init(window, context);
 
     ImGui::GetIO().IniFilename = nullptr;
 
     // initialize fonts
-    {
-        // default font
-        {
-            printf("Initializing default font\n");
-            ImFontConfig cfg;
-            cfg.SizePixels = 13.0f*fontScale;
-            ImGui::GetIO().Fonts->AddFontDefault(&cfg);
-        }
+    const int64_t tStart_us = Profiler::time_us();
+
+    ImGui::SetFontSDF(fontSDF);
 
-        for (const auto & font : fonts) {
-            printf("Initializing font '%s'\n", font.filename.c_str());
-            if (ImGui::TryLoadFont(font) == false) {
-                fprintf(stderr, "Error: failed to load font '%s'\n", font.filename.c_str());
+    // the default font comes first
+    std::vector<ImGui::FontInfo> fontsAll;
+    fontsAll.reserve(fonts.size() + 1);
+    fontsAll.push_back({ .filename = "", .size = 13.0f*fontScale, .merge = false, .rangeMin = 0, .rangeMax = 0, });
+    for (const auto & font : fonts) {
+        fontsAll.push_back(font);
+    }
+
+    const uint64_t fontAtlasKey = ImGui::GetFontAtlasKey(fontScale, fontsAll);
+
+    // the font files are loaded asynchronously, so the first frame does not wait for them
+    // the default font is built into ImGui and is available immediately
+    if (fnameFontAtlas.empty() == false && ImGui::LoadFontAtlas(fnameFontAtlas, fontAtlasKey)) {
+        printf("Loaded font atlas from '%s' in %.2f ms\n", fnameFontAtlas.c_str(), 1e-3f*(Profiler::time_us() - tStart_us));
+
+        for (const auto & font : fontsAll) {
+            if (font.filename.empty()) {
+                ImGui::RegisterFont(font);
+            } else {
+                ImGui::AddFontAsync(font, true);
             }
         }
+    } else {
+        for (const auto & font : fontsAll) {
+            if (font.filename.empty()) {
+                ImGui::TryLoadFont(font);
+            } else {
+                ImGui::AddFontAsync(font, false);
+            }
+        }
+
+        if (ImGui::BuildFontAtlas() == false) {
+            fprintf(stderr, "Error: failed to build the font atlas\n");
+            return false;
+        }
+
+        const auto & atlas = *ImGui::GetIO().Fonts;
+        printf("Built %dx%d %sfont atlas in %.2f ms\n", atlas.TexWidth, atlas.TexHeight, fontSDF ? "SDF " : "", 1e-3f*(Profiler::time_us() - tStart_us));
+    }
+
+    if (fnameFontAtlas.empty() == false) {
+        ImGui::SetFontAtlasCache(fnameFontAtlas, fontAtlasKey);
+    }
+
+    // hot-swapped into the atlas when they arrive
+    for (const auto & font : fonts) {
+        if (font.filename.empty()) {
+            continue;
+        }
+
+        assets.request(font.filename, [](const Asset & asset) {
+            ImGui::SetFontData(asset.path, asset.state == Asset::State::Ready ? asset.data : std::vector<uint8_t>());
+        });
     }
 
     // dummy frame to initialize stuff
@@ -68,6 +182,15 @@ bool StateSDL::initImGui(float fontScale, const std::vector<ImGui::FontInfo> & f
 bool StateSDL::deinitWindow() {
     printf("Deinitializing SDL\n");
 
+#ifndef __EMSCRIPTEN__
+    if (fbo) {
+        g_gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+        g_gl.deleteFramebuffers(1, &fbo);
+        g_gl.deleteRenderbuffers(1, &rbo);
+        fbo = rbo = 0;
+    }
+#endif
+
     SDL_GL_DeleteContext(context);
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -2,19 +2,35 @@
 
 #include "common.h"
 
+#include <string>
 #include <vector>
 
 struct SDL_Window;
+struct Assets;
 
 struct StateSDL {
     int windowX = 1200;
     int windowY = 800;
 
+    // native only - hidden window rendering into an offscreen framebuffer with vsync disabled
+    bool isHeadless = false;
+
+    // rasterized font atlas cache - created on the first start, empty to disable
+    std::string fnameFontAtlas;
+
+    // render the text using signed distance fields
+    bool fontSDF = false;
+
     void * context = nullptr;
     SDL_Window * window = nullptr;
 
+    // headless
+    unsigned int fbo = 0;
+    unsigned int rbo = 0;
+
     bool initWindow(const char * windowTitle);
-    bool initImGui(float fontScale, const std::vector<ImGui::FontInfo> & fonts);
+    // the font files are requested from assets and added to the atlas when they arrive
+    bool initImGui(float fontScale, const std::vector<ImGui::FontInfo> & fonts, Assets & assets);
     bool deinitWindow();
     bool deinitImGui();
 };
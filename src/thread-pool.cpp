@@ -0,0 +1,220 @@
+#include "thread-pool.h"
+
+#include <cstdio>
+#include <algorithm>
+
+namespace {
+
+// the pool and the queue of the current worker thread
+thread_local ThreadPool * t_pool = nullptr;
+thread_local int t_index = -1;
+
+}
+
+bool ThreadPool::init(int nThreads, std::function<void()> onComplete) {
+    deinit();
+
+    this->onComplete = std::move(onComplete);
+
+#ifdef GGWEB_HAS_THREADS
+    if (nThreads <= 0) {
+        nThreads = std::max(1, (int) std::thread::hardware_concurrency() - 1);
+    }
+
+    isRunning = true;
+
+    for (int i = 0; i < nThreads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    for (int i = 0; i < nThreads; ++i) {
+        workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+
+    printf("Started thread pool with %d workers\n", nThreads);
+#else
+    (void) nThreads;
+    printf("No thread support - the thread pool tasks run inline\n");
+#endif
+
+    return true;
+}
+
+void ThreadPool::deinit() {
+    if (workers.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutexWake);
+        isRunning = false;
+    }
+    cvWake.notify_all();
+
+    for (auto & worker : workers) {
+        worker.join();
+    }
+
+    workers.clear();
+    queues.clear();
+}
+
+void ThreadPool::run(Task task) {
+    if (workers.empty()) {
+        task();
+        return;
+    }
+
+    const int idx = t_pool == this ? t_index : (int) (iNextQueue++ % queues.size());
+
+    {
+        std::lock_guard<std::mutex> lock(queues[idx]->mutex);
+        queues[idx]->tasks.push_back(std::move(task));
+    }
+
+    ++nQueued;
+
+    {
+        std::lock_guard<std::mutex> lock(mutexWake);
+    }
+    cvWake.notify_one();
+}
+
+void ThreadPool::parallelFor(int begin, int end, int grain, const std::function<void(int, int)> & fn) {
+    if (end <= begin) {
+        return;
+    }
+
+    grain = std::max(1, grain);
+
+    const int nChunks = (end - begin + grain - 1)/grain;
+
+    auto chunk = [&](int c) {
+        const int i0 = begin + c*grain;
+        fn(i0, std::min(end, i0 + grain));
+    };
+
+    if (workers.empty() || nChunks == 1) {
+        for (int c = 0; c < nChunks; ++c) {
+            chunk(c);
+        }
+        return;
+    }
+
+    // the chunks are claimed from a counter shared by the helper tasks and the calling thread, so the caller works
+    // only on the chunks of this call and never on other tasks of the pool (like the backend computations), which
+    // would delay it. a helper that starts after all chunks are claimed returns right away, so the state is shared
+    struct State {
+        std::atomic<int> iNext { 0 };
+        std::atomic<int> nDone { 0 };
+    };
+
+    auto state = std::make_shared<State>();
+
+    // fn is used only for claimed chunks, and the caller waits for all of them
+    const auto * pfn = &fn;
+    auto work = [state, pfn, begin, end, grain, nChunks]() {
+        int c = 0;
+        while ((c = state->iNext++) < nChunks) {
+            const int i0 = begin + c*grain;
+            (*pfn)(i0, std::min(end, i0 + grain));
+            ++state->nDone;
+        }
+    };
+
+    const int nHelpers = std::min(nChunks - 1, nWorkers());
+    for (int i = 0; i < nHelpers; ++i) {
+        run(work);
+    }
+
+    work();
+
+    // the chunks claimed by the helpers are still running
+    while (state->nDone < nChunks) {
+        std::this_thread::yield();
+    }
+}
+
+int ThreadPool::processCompleted() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(mutexCompleted);
+        tasks.swap(completed);
+    }
+
+    for (auto & task : tasks) {
+        task();
+    }
+
+    return (int) tasks.size();
+}
+
+bool ThreadPool::pop(int idx, Task & task) {
+    const int n = (int) queues.size();
+
+    // own queue - newest first
+    if (idx >= 0) {
+        auto & queue = *queues[idx];
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty() == false) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            --nQueued;
+            return true;
+        }
+    }
+
+    // steal - oldest first
+    for (int k = 1; k <= n; ++k) {
+        const int i = (std::max(idx, 0) + k) % n;
+        if (i == idx) {
+            continue;
+        }
+
+        auto & queue = *queues[i];
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty() == false) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --nQueued;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::complete(Task onDone) {
+    {
+        std::lock_guard<std::mutex> lock(mutexCompleted);
+        completed.push_back(std::move(onDone));
+    }
+
+    if (onComplete) {
+        onComplete();
+    }
+}
+
+void ThreadPool::workerLoop(int idx) {
+    t_pool = this;
+    t_index = idx;
+
+    Task task;
+    while (true) {
+        if (pop(idx, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutexWake);
+        cvWake.wait(lock, [this]() { return nQueued > 0 || isRunning == false; });
+
+        // the queued tasks are finished before exiting
+        if (isRunning == false && nQueued == 0) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+// the web build has threads only when compiled with -pthread (GGWEB_WASM_THREADS)
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define GGWEB_HAS_THREADS
+#endif
+
+//
+// small work-stealing thread pool
+//
+// each worker has its own queue - it takes tasks from the back of its queue (newest first) and, when it is empty,
+// steals from the front of the other queues (oldest first). tasks submitted from a worker go to its own queue
+//
+// without threads (web build without GGWEB_WASM_THREADS) all tasks are executed inline
+//
+struct ThreadPool {
+    using Task = std::function<void()>;
+
+    // nThreads <= 0 - one worker per hardware thread, excluding the main thread
+    // on the web, the hardware concurrency is navigator.hardwareConcurrency
+    // onComplete is called from the worker threads each time a task with a completion callback has finished
+    bool init(int nThreads, std::function<void()> onComplete);
+
+    // finish all queued tasks and stop the workers
+    void deinit();
+
+    int nWorkers() const { return (int) workers.size(); }
+
+    // run a task on the pool
+    void run(Task task);
+
+    // run a task and get its result through a future
+    template <typename F>
+    auto async(F && f) -> std::future<decltype(f())> {
+        auto task = std::make_shared<std::packaged_task<decltype(f())()>>(std::forward<F>(f));
+        auto res = task->get_future();
+
+        run([task]() { (*task)(); });
+
+        return res;
+    }
+
+    // run a task and pass its result to onDone on the main thread - see processCompleted()
+    template <typename F, typename D>
+    void async(F && f, D && onDone) {
+        run([this, f = std::forward<F>(f), onDone = std::forward<D>(onDone)]() mutable {
+            if constexpr (std::is_void_v<decltype(f())>) {
+                f();
+                complete(std::move(onDone));
+            } else {
+                auto res = std::make_shared<decltype(f())>(f());
+                complete([onDone = std::move(onDone), res]() mutable { onDone(std::move(*res)); });
+            }
+        });
+    }
+
+    // call fn(i0, i1) for consecutive chunks of [begin, end) with at most grain elements and wait for all of them
+    // the calling thread takes part in the work, so this can also be called from a task - it runs only the chunks
+    // of this call, not the other tasks of the pool
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)> & fn);
+
+    // call the completion callbacks of the finished tasks - call this from the main thread
+    // returns the number of callbacks that were called
+    int processCompleted();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // take a task from the queue idx or steal one from the others - idx < 0 only steals
+    bool pop(int idx, Task & task);
+
+    void complete(Task onDone);
+
+    void workerLoop(int idx);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<int> nQueued { 0 };
+    std::atomic<bool> isRunning { false };
+    std::atomic<unsigned> iNextQueue { 0 };
+
+    // idle workers wait here
+    std::mutex mutexWake;
+    std::condition_variable cvWake;
+
+    std::function<void()> onComplete;
+
+    std::mutex mutexCompleted;
+    std::vector<Task> completed;
+};
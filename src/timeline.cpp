@@ -0,0 +1,105 @@
+#include "timeline.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// the frames are not woken up with sub-millisecond precision - a frame that arrives slightly early
+// still counts as the next tick
+constexpr float kTolerance_s = 0.001f;
+
+}
+
+float Timeline::linear(float x) {
+    return x;
+}
+
+float Timeline::smooth(float x) {
+    return x*x*(3.0f - 2.0f*x);
+}
+
+Timeline::Id Timeline::tween(float duration, float rate, Easing easing) {
+    const Id id = nextId++;
+    animations.push_back({ id, T, std::max(0.0f, duration), std::max(0.0f, rate), easing ? easing : linear, });
+
+    return id;
+}
+
+Timeline::Id Timeline::loop(float rate) {
+    const Id id = nextId++;
+    animations.push_back({ id, T, -1.0f, std::max(0.0f, rate), linear, });
+
+    return id;
+}
+
+void Timeline::stop(Id id) {
+    animations.erase(std::remove_if(animations.begin(), animations.end(), [id](const Animation & a) { return a.id == id; }), animations.end());
+}
+
+bool Timeline::isActive(Id id) const {
+    return find(id) != nullptr;
+}
+
+float Timeline::value(Id id) const {
+    const auto a = find(id);
+    if (a == nullptr || a->duration <= 0.0f) {
+        return 1.0f;
+    }
+
+    const float x = std::clamp((T - a->tStart)/a->duration, 0.0f, 1.0f);
+
+    return a->easing(x);
+}
+
+int Timeline::ticks(Id id) const {
+    const auto a = find(id);
+    if (a == nullptr || a->rate <= 0.0f) {
+        return 0;
+    }
+
+    return (int) std::floor((T - a->tStart + kTolerance_s)*a->rate);
+}
+
+void Timeline::update(float T) {
+    this->T = T;
+
+    animations.erase(std::remove_if(animations.begin(), animations.end(), [T](const Animation & a) {
+        return a.duration >= 0.0f && T >= a.tStart + a.duration;
+    }), animations.end());
+}
+
+float Timeline::nextUpdate() const {
+    float res = -1.0f;
+
+    for (const auto & a : animations) {
+        float dt = 0.0f;
+
+        if (a.rate > 0.0f) {
+            const float k = std::floor((T - a.tStart + kTolerance_s)*a.rate) + 1.0f;
+            dt = a.tStart + k/a.rate - T;
+
+            // render the final state of the tween exactly at the end
+            if (a.duration >= 0.0f) {
+                dt = std::min(dt, a.tStart + a.duration - T);
+            }
+        }
+
+        dt = std::max(0.0f, dt);
+        if (res < 0.0f || dt < res) {
+            res = dt;
+        }
+    }
+
+    return res;
+}
+
+const Timeline::Animation * Timeline::find(Id id) const {
+    for (const auto & a : animations) {
+        if (a.id == id) {
+            return &a;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <cstdint> // uint32_t
+
+//
+// scheduler for the animations of the UI
+//
+// each animation declares how many frames per second it needs, so the main loop knows exactly when the next
+// frame is due - a 2 Hz blinking indicator wakes up the app 4 times per second instead of rendering at full rate
+// a rate of 0 means that the animation needs every frame
+//
+// the time is in seconds, as returned by ImGui::GetTime()
+//
+struct Timeline {
+    using Id = uint32_t;
+    using Easing = float (*)(float x);
+
+    static float linear(float x);
+    static float smooth(float x);
+
+    // one-shot transition over duration seconds, starting now - value() goes from 0 to 1
+    Id tween(float duration, float rate = 0.0f, Easing easing = linear);
+
+    // periodic animation that runs until stop()
+    Id loop(float rate = 0.0f);
+
+    void stop(Id id);
+    bool isActive(Id id) const;
+
+    // eased progress of a tween - 1 if it has finished or does not exist
+    float value(Id id) const;
+
+    // number of whole update periods since the start of the animation - for example, the state of a blinking indicator
+    int ticks(Id id) const;
+
+    // call at the start of each frame - removes the finished tweens
+    void update(float T);
+
+    // seconds until the next frame is needed: 0 - the next frame, < 0 - there are no active animations
+    float nextUpdate() const;
+
+    bool empty() const { return animations.empty(); }
+
+private:
+    struct Animation {
+        Id id;
+
+        float tStart;
+        float duration; // < 0 for loops
+        float rate;
+
+        Easing easing;
+    };
+
+    const Animation * find(Id id) const;
+
+    std::vector<Animation> animations;
+
+    Id nextId = 1;
+    float T = 0.0f;
+};
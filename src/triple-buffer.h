@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint> // uint8_t
+
+//
+// lock-free single-producer / single-consumer triple buffer
+//
+// the producer fills its back slot and publishes it, the consumer picks up the latest published slot
+// neither side ever waits for the other - if the producer is faster, the intermediate values are dropped
+//
+template <typename T>
+struct TripleBuffer {
+    //
+    // producer
+    //
+
+    // the slot to write to - it is owned by the producer until publish() is called
+    T & back() { return slots[iBack]; }
+
+    // make the back slot available to the consumer and continue with a free slot
+    // note: the new back slot contains an old value, not the one just published
+    void publish() {
+        const uint8_t prev = middle.exchange(iBack | kDirty, std::memory_order_acq_rel);
+        iBack = prev & kIndexMask;
+    }
+
+    //
+    // consumer
+    //
+
+    // pick up the latest published slot - returns true if there is a new one since the last call
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & kDirty) == 0) {
+            return false;
+        }
+
+        const uint8_t prev = middle.exchange(iFront, std::memory_order_acq_rel);
+        iFront = prev & kIndexMask;
+
+        return true;
+    }
+
+    // the slot to read from - it is owned by the consumer until update() is called
+    const T & front() const { return slots[iFront]; }
+
+private:
+    static constexpr uint8_t kDirty     = 0x4;
+    static constexpr uint8_t kIndexMask = 0x3;
+
+    T slots[3];
+
+    uint8_t iBack  = 0;
+    uint8_t iFront = 1;
+
+    // index of the slot in the middle + dirty flag if it has not been picked up by the consumer yet
+    std::atomic<uint8_t> middle { 2 };
+};
@@ -63,6 +63,13 @@
 //---- Use 32-bit vertex indices (default is 16-bit) to allow meshes with more than 64K vertices. Render function needs to support it.
 #define ImDrawIdx unsigned int
 
+//---- Per-thread current context. ImGui::MemAlloc()/MemFree() update GImGui->IO.MetricsActiveAllocations without
+// synchronization, so the threads that fill draw lists (the thread pool workers) must not see the context of the
+// main thread. The threads that need the context set it with ImGui::SetCurrentContext() (see RenderThread).
+struct ImGuiContext;
+inline thread_local ImGuiContext* ImGui_ThreadContext = nullptr;
+#define GImGui ImGui_ThreadContext
+
 //---- Tip: You can add extra functions within the ImGui:: namespace, here or in your own headers files.
 /*
 namespace ImGui
@@ -0,0 +1,259 @@
+#include "imgui-extra/imgui_alloc.h"
+
+#include "imgui/imgui.h"
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+// the header in front of each block keeps the payload aligned to max_align_t
+constexpr size_t kHeaderSize = 16;
+
+constexpr size_t kChunkSize = 64*1024;
+constexpr size_t kFrameArenaSize = 64*1024;
+
+constexpr size_t kClassSizes[] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, };
+constexpr int kNumClasses = sizeof(kClassSizes)/sizeof(kClassSizes[0]);
+constexpr size_t kMaxClassSize = kClassSizes[kNumClasses - 1];
+
+// size class of the blocks that are allocated directly with malloc
+constexpr uint32_t kClassLarge = 0xFFFFFFFF;
+
+struct Header {
+    uint32_t cls;
+    uint32_t unused;
+    uint64_t size; // only for the large blocks
+};
+
+static_assert(sizeof(Header) <= kHeaderSize, "the block header does not fit");
+
+struct Pool {
+    std::mutex mutex;
+
+    // the free blocks are linked through their payload
+    void * freeList = nullptr;
+};
+
+// bump allocator - whatever does not fit goes to malloc and the arena grows at the next reset
+struct FrameArena {
+    uint8_t * data = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+
+    std::vector<void *> overflow;
+    size_t nOverflowBytes = 0;
+};
+
+struct State {
+    State() {
+        for (size_t i = 0, cls = 0; i < sizeof(classOf); ++i) {
+            while (16*i > kClassSizes[cls]) ++cls;
+            classOf[i] = (uint8_t) cls;
+        }
+    }
+
+    // size class for each multiple of 16 bytes
+    uint8_t classOf[kMaxClassSize/16 + 1];
+
+    Pool pools[kNumClasses];
+
+    std::atomic<int64_t> nAllocs { 0 };
+    std::atomic<int64_t> nBytes { 0 };
+    std::atomic<int64_t> nAllocsHeap { 0 };
+    std::atomic<int64_t> nBytesInUse { 0 };
+    std::atomic<int64_t> nBytesReserved { 0 };
+
+    // values of the counters at the start of the current frame
+    int64_t nAllocsStart = 0;
+    int64_t nBytesStart = 0;
+    int64_t nAllocsHeapStart = 0;
+
+    ImGuiAllocStats lastFrame = {};
+
+    FrameArena arena;
+};
+
+// never destroyed - the blocks of static objects can be freed during the static destruction
+State & getState() {
+    static State * state = new State();
+    return *state;
+}
+
+void * poolAlloc(size_t size, void * ) {
+    auto & state = getState();
+
+    state.nAllocs.fetch_add(1, std::memory_order_relaxed);
+    state.nBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (size > kMaxClassSize) {
+        auto header = (Header *) malloc(kHeaderSize + size);
+        if (header == nullptr) {
+            return nullptr;
+        }
+
+        header->cls = kClassLarge;
+        header->size = size;
+
+        state.nAllocsHeap.fetch_add(1, std::memory_order_relaxed);
+        state.nBytesInUse.fetch_add(size, std::memory_order_relaxed);
+        state.nBytesReserved.fetch_add(kHeaderSize + size, std::memory_order_relaxed);
+
+        return (uint8_t *) header + kHeaderSize;
+    }
+
+    const int cls = state.classOf[(size + 15)/16];
+    const size_t blockSize = kHeaderSize + kClassSizes[cls];
+
+    auto & pool = state.pools[cls];
+
+    void * res = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        if (pool.freeList == nullptr) {
+            auto chunk = (uint8_t *) malloc(kChunkSize);
+            if (chunk == nullptr) {
+                return nullptr;
+            }
+
+            state.nAllocsHeap.fetch_add(1, std::memory_order_relaxed);
+            state.nBytesReserved.fetch_add(kChunkSize, std::memory_order_relaxed);
+
+            // carve the chunk into blocks, in reverse so that they are handed out in address order
+            for (size_t n = kChunkSize/blockSize; n > 0; --n) {
+                auto header = (Header *) (chunk + (n - 1)*blockSize);
+                header->cls = cls;
+
+                void * payload = (uint8_t *) header + kHeaderSize;
+                *(void **) payload = pool.freeList;
+                pool.freeList = payload;
+            }
+        }
+
+        res = pool.freeList;
+        pool.freeList = *(void **) res;
+    }
+
+    state.nBytesInUse.fetch_add(kClassSizes[cls], std::memory_order_relaxed);
+
+    return res;
+}
+
+void poolFree(void * ptr, void * ) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    auto & state = getState();
+
+    auto header = (Header *) ((uint8_t *) ptr - kHeaderSize);
+
+    if (header->cls == kClassLarge) {
+        state.nBytesInUse.fetch_sub(header->size, std::memory_order_relaxed);
+        state.nBytesReserved.fetch_sub(kHeaderSize + header->size, std::memory_order_relaxed);
+
+        free(header);
+        return;
+    }
+
+    auto & pool = state.pools[header->cls];
+
+    state.nBytesInUse.fetch_sub(kClassSizes[header->cls], std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(pool.mutex);
+
+    *(void **) ptr = pool.freeList;
+    pool.freeList = ptr;
+}
+
+}
+
+void ImGui_InstallAllocator() {
+    ImGui::SetAllocatorFunctions(poolAlloc, poolFree, nullptr);
+}
+
+void ImGui_AllocNewFrame() {
+    auto & state = getState();
+    auto & arena = state.arena;
+
+    state.lastFrame = ImGui_GetAllocStats(true);
+
+    state.nAllocsStart     = state.nAllocs.load(std::memory_order_relaxed);
+    state.nBytesStart      = state.nBytes.load(std::memory_order_relaxed);
+    state.nAllocsHeapStart = state.nAllocsHeap.load(std::memory_order_relaxed);
+
+    // grow the arena, so that the next frame fits without overflowing
+    if (arena.overflow.empty() == false) {
+        for (auto p : arena.overflow) {
+            free(p);
+        }
+        arena.overflow.clear();
+
+        state.nBytesReserved.fetch_sub(arena.capacity + arena.nOverflowBytes, std::memory_order_relaxed);
+
+        const size_t capacity = std::max(2*arena.capacity, arena.capacity + arena.nOverflowBytes);
+
+        free(arena.data);
+        arena.data = (uint8_t *) malloc(capacity);
+        arena.capacity = arena.data ? capacity : 0;
+        arena.nOverflowBytes = 0;
+
+        state.nBytesReserved.fetch_add(arena.capacity, std::memory_order_relaxed);
+    }
+
+    arena.used = 0;
+}
+
+ImGuiAllocStats ImGui_GetAllocStats(bool current) {
+    auto & state = getState();
+
+    ImGuiAllocStats res = state.lastFrame;
+
+    if (current) {
+        res.nAllocs          = state.nAllocs.load(std::memory_order_relaxed)     - state.nAllocsStart;
+        res.nBytes           = state.nBytes.load(std::memory_order_relaxed)      - state.nBytesStart;
+        res.nAllocsHeap      = state.nAllocsHeap.load(std::memory_order_relaxed) - state.nAllocsHeapStart;
+        res.nBytesFrameArena = state.arena.used + state.arena.nOverflowBytes;
+    }
+
+    res.nBytesInUse    = state.nBytesInUse.load(std::memory_order_relaxed);
+    res.nBytesReserved = state.nBytesReserved.load(std::memory_order_relaxed);
+
+    return res;
+}
+
+void * ImGui_FrameAlloc(size_t size, size_t align) {
+    auto & state = getState();
+    auto & arena = state.arena;
+
+    IM_ASSERT(align > 0 && (align & (align - 1)) == 0 && align <= alignof(std::max_align_t));
+
+    if (arena.data == nullptr) {
+        arena.data = (uint8_t *) malloc(kFrameArenaSize);
+        arena.capacity = arena.data ? kFrameArenaSize : 0;
+
+        state.nAllocsHeap.fetch_add(1, std::memory_order_relaxed);
+        state.nBytesReserved.fetch_add(arena.capacity, std::memory_order_relaxed);
+    }
+
+    const size_t offset = (arena.used + align - 1) & ~(align - 1);
+    if (offset + size <= arena.capacity) {
+        arena.used = offset + size;
+        return arena.data + offset;
+    }
+
+    void * res = malloc(std::max<size_t>(size, 1));
+    if (res) {
+        arena.overflow.push_back(res);
+        arena.nOverflowBytes += size;
+
+        state.nAllocsHeap.fetch_add(1, std::memory_order_relaxed);
+        state.nBytesReserved.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    return res;
+}
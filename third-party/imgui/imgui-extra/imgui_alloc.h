@@ -0,0 +1,46 @@
+/*! \file imgui_alloc.h
+ *  \brief Memory allocator for Dear ImGui - size-class pools and a per-frame arena.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// - size-class pools: the blocks of up to 2 KB come from free lists carved out of 64 KB chunks, so the many small
+//   allocations of ImGui do not go through malloc (the dlmalloc of Emscripten in particular)
+//   the chunks are reused, but never returned to the system
+//   the larger blocks, like the vertex and index buffers, go directly to malloc
+// - frame arena: bump allocator for transient data that lives until the next ImGui_AllocNewFrame()
+//
+// the pools are thread-safe, since the draw lists can grow on worker threads. ImGui::MemAlloc() also updates
+// IO.MetricsActiveAllocations of the current context without synchronization - this is safe because the current
+// context is per thread (see imconfig-vtx32.h): the workers have none, and the render thread, which has one, does
+// not allocate while the main thread is running (see RenderThread::submit())
+// the frame arena must be used only from the main thread
+//
+
+struct ImGuiAllocStats {
+    // per frame
+    int64_t nAllocs;          // calls to the allocator
+    int64_t nBytes;           // requested bytes
+    int64_t nAllocsHeap;      // allocations that reached malloc - large blocks and new chunks
+    int64_t nBytesFrameArena; // transient bytes from the frame arena
+
+    // totals
+    int64_t nBytesInUse;    // live blocks
+    int64_t nBytesReserved; // pool chunks + large blocks + frame arena
+};
+
+// install the allocator with ImGui::SetAllocatorFunctions() - call before ImGui::CreateContext()
+void ImGui_InstallAllocator();
+
+// call at the start of each frame - starts new per-frame counters and releases the frame arena
+void ImGui_AllocNewFrame();
+
+// the per-frame counters are of the last completed frame, or of the current frame if current is true
+ImGuiAllocStats ImGui_GetAllocStats(bool current = false);
+
+// transient memory, valid until the next ImGui_AllocNewFrame() - main thread only
+void * ImGui_FrameAlloc(size_t size, size_t align = alignof(std::max_align_t));
@@ -0,0 +1,173 @@
+#include "imgui-extra/imgui_draw_simd.h"
+#include "imgui-extra/imgui_draw_simd_kernels.h"
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+
+namespace {
+
+// one table for each segment count, created on first use and never destroyed
+std::mutex g_circleMutex;
+std::atomic<const float *> g_circleTables[IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX + 1];
+
+struct Scratch {
+    std::vector<float> data;
+    std::vector<int> dataInt;
+};
+
+thread_local Scratch g_scratch;
+
+// -1 - not selected yet
+std::atomic<int> g_level { -1 };
+
+bool isSupported(ImGuiSimdLevel level) {
+    switch (level) {
+        case ImGuiSimdLevel::Scalar:
+            return true;
+        case ImGuiSimdLevel::SSE2:
+#if defined(IMGUI_DRAW_SIMD_SSE2)
+            return true;
+#else
+            return false;
+#endif
+        case ImGuiSimdLevel::AVX2:
+#if defined(IMGUI_DRAW_SIMD_AVX2)
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+    }
+
+    return false;
+}
+
+const ImGuiDrawSimdKernels & selectKernels(ImGuiSimdLevel level) {
+    switch (level) {
+        case ImGuiSimdLevel::Scalar:
+            break;
+        case ImGuiSimdLevel::SSE2:
+#if defined(IMGUI_DRAW_SIMD_SSE2)
+            return getKernels<VecSSE2>();
+#else
+            break;
+#endif
+        case ImGuiSimdLevel::AVX2:
+#if defined(IMGUI_DRAW_SIMD_AVX2)
+            return ImGui_GetDrawSimdKernelsAVX2();
+#else
+            break;
+#endif
+    }
+
+    return getKernels<VecScalar>();
+}
+
+const ImGuiDrawSimdKernels & currentKernels() {
+    return selectKernels(ImGui_GetSimdLevel());
+}
+
+}
+
+ImGuiCircleTable ImGui_GetCircleTable(int numSegments) {
+    IM_ASSERT(numSegments >= 3 && numSegments <= IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX);
+
+    auto & slot = g_circleTables[numSegments];
+
+    const float * data = slot.load(std::memory_order_acquire);
+    if (data == nullptr) {
+        std::lock_guard<std::mutex> lock(g_circleMutex);
+
+        data = slot.load(std::memory_order_relaxed);
+        if (data == nullptr) {
+            const int n = numSegments + kSimdPad + 1;
+
+            float * table = new float[2*n];
+            for (int i = 0; i < n; ++i) {
+                const double a = (2.0*IM_PI*(i % numSegments))/numSegments;
+                table[i]     = (float) std::cos(a);
+                table[n + i] = (float) std::sin(a);
+            }
+
+            slot.store(table, std::memory_order_release);
+            data = table;
+        }
+    }
+
+    return { data, data + numSegments + kSimdPad + 1 };
+}
+
+float * ImGui_GetDrawSimdScratch(int size) {
+    auto & data = g_scratch.data;
+    if ((int) data.size() < size) {
+        data.resize(size);
+    }
+
+    return data.data();
+}
+
+int * ImGui_GetDrawSimdScratchInt(int size) {
+    auto & data = g_scratch.dataInt;
+    if ((int) data.size() < size) {
+        data.resize(size);
+    }
+
+    return data.data();
+}
+
+ImGuiSimdLevel ImGui_GetSimdLevel() {
+    int level = g_level.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = (int) ImGuiSimdLevel::Scalar;
+        for (auto best : { ImGuiSimdLevel::AVX2, ImGuiSimdLevel::SSE2, }) {
+            if (isSupported(best)) {
+                level = (int) best;
+                break;
+            }
+        }
+
+        g_level.store(level, std::memory_order_relaxed);
+    }
+
+    return (ImGuiSimdLevel) level;
+}
+
+bool ImGui_SetSimdLevel(ImGuiSimdLevel level) {
+    if (isSupported(level) == false) {
+        return false;
+    }
+
+    g_level.store((int) level, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool ImGui_IsSimdLevelSupported(ImGuiSimdLevel level) {
+    return isSupported(level);
+}
+
+const char * ImGui_GetSimdLevelName(ImGuiSimdLevel level) {
+    switch (level) {
+        case ImGuiSimdLevel::Scalar:  return "scalar";
+        case ImGuiSimdLevel::SSE2:    return "sse2";
+        case ImGuiSimdLevel::AVX2:    return "avx2";
+    }
+
+    return "unknown";
+}
+
+void ImGui_AddCirclesFilled(ImDrawList * drawList, const ImGuiCircle * circles, int count, int numSegments) {
+    currentKernels().addCirclesFilled(drawList, circles, count, numSegments);
+}
+
+void ImGui_AddLines(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col, float thickness) {
+    currentKernels().addLines(drawList, points, count, col, thickness);
+}
+
+void ImGui_AddPolyline(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col, ImDrawFlags flags, float thickness) {
+    currentKernels().addPolyline(drawList, points, count, col, flags, thickness);
+}
+
+void ImGui_AddConvexPolyFilled(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col) {
+    currentKernels().addConvexPolyFilled(drawList, points, count, col);
+}
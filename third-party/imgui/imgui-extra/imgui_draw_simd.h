@@ -0,0 +1,57 @@
+/*! \file imgui_draw_simd.h
+ *  \brief Vectorized vertex generation for the ImDrawList primitives.
+ */
+
+#pragma once
+
+#include "imgui/imgui.h"
+
+//
+// replacements for the ImDrawList primitives that dominate the custom drawing (plots with many circles and lines).
+// the geometry is equivalent to the stock functions - same segment counts, same anti-aliased fringe - but not
+// bit-identical to it: the circles use their own tessellation tables and the lines are always built from geometry
+//
+// - the points of the circles come from cached unit circles - no trig per primitive
+// - the edge and vertex normals (a sqrt and two divisions per point) are computed 4 or 8 points at a time:
+//   SSE2 or AVX2, selected at runtime - the web build uses the scalar path
+// - the bulk functions reserve the vertices and indices of the whole batch at once
+//
+// all the paths produce the same bits as the scalar path - the kernels use only correctly rounded operations in the
+// same order, and the sources are built with -ffp-contract=off. "ggweb-bench --verify" compares them
+//
+// the anti-aliased lines are always built from geometry - the baked line texture (ImDrawListFlags_AntiAliasedLinesUseTex)
+// is not used. without ImDrawListFlags_AntiAliasedLines / ImDrawListFlags_AntiAliasedFill the stock ImDrawList
+// functions are called
+//
+// the functions only touch the draw list they are given, so they can be used from the ParallelDraw workers
+//
+
+struct ImGuiCircle {
+    ImVec2 center;
+    float radius;
+    ImU32 col;
+};
+
+enum class ImGuiSimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+};
+
+// the level that is used - the best one supported by the build and the CPU, unless changed with ImGui_SetSimdLevel()
+ImGuiSimdLevel IMGUI_API ImGui_GetSimdLevel();
+
+// for testing - returns false if the level is not supported
+bool IMGUI_API ImGui_SetSimdLevel(ImGuiSimdLevel level);
+bool IMGUI_API ImGui_IsSimdLevelSupported(ImGuiSimdLevel level);
+
+const char * IMGUI_API ImGui_GetSimdLevelName(ImGuiSimdLevel level);
+
+// numSegments <= 0 - automatic, as ImDrawList::AddCircleFilled()
+void IMGUI_API ImGui_AddCirclesFilled(ImDrawList * drawList, const ImGuiCircle * circles, int count, int numSegments = 0);
+
+// points[2*i] - points[2*i + 1] for i in [0, count), as count calls to ImDrawList::AddLine()
+void IMGUI_API ImGui_AddLines(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col, float thickness = 1.0f);
+
+void IMGUI_API ImGui_AddPolyline(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col, ImDrawFlags flags, float thickness);
+void IMGUI_API ImGui_AddConvexPolyFilled(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col);
@@ -0,0 +1,11 @@
+// compiled with -mavx2 and only called after checking the CPU (see ImGui_GetSimdLevel())
+//
+// nothing with external linkage may be instantiated here (std containers, inline functions of the ImGui headers),
+// since the linker could pick the AVX2 copy for the rest of the program - the kernels are in an anonymous namespace
+// and get their memory from imgui_draw_simd.cpp
+
+#include "imgui-extra/imgui_draw_simd_kernels.h"
+
+const ImGuiDrawSimdKernels & ImGui_GetDrawSimdKernelsAVX2() {
+    return getKernels<VecAVX2>();
+}
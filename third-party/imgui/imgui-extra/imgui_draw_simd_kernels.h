@@ -0,0 +1,573 @@
+/*! \file imgui_draw_simd_kernels.h
+ *  \brief Internal - the kernels of imgui_draw_simd.cpp, compiled once for each instruction set.
+ */
+
+#pragma once
+
+#include "imgui-extra/imgui_draw_simd.h"
+
+#include "imgui/imgui_internal.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGUI_DRAW_SIMD_SSE2
+#include <immintrin.h>
+#endif
+
+// the widest vector - the arrays given to the kernels are padded with this many elements
+constexpr int kSimdPad = 8;
+
+// unit circle with numSegments points starting at angle 0, followed by the first kSimdPad + 1 points again
+struct ImGuiCircleTable {
+    const float * x;
+    const float * y;
+};
+
+// cached - can be called from any thread
+ImGuiCircleTable ImGui_GetCircleTable(int numSegments);
+
+// per-thread memory, kept between the calls - a call invalidates the pointer returned by the previous one
+float * ImGui_GetDrawSimdScratch(int size);
+int * ImGui_GetDrawSimdScratchInt(int size);
+
+struct ImGuiDrawSimdKernels {
+    void (*addCirclesFilled)(ImDrawList * drawList, const ImGuiCircle * circles, int count, int numSegments);
+    void (*addLines)(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col, float thickness);
+    void (*addPolyline)(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col, ImDrawFlags flags, float thickness);
+    void (*addConvexPolyFilled)(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col);
+};
+
+// in imgui_draw_simd_avx2.cpp - only built for x86
+const ImGuiDrawSimdKernels & ImGui_GetDrawSimdKernelsAVX2();
+
+namespace {
+
+//
+// vector types
+//
+// only the operations that are correctly rounded in IEEE 754 (add, sub, mul, div, sqrt), so that each lane computes
+// the same bits as VecScalar
+//
+
+struct VecScalar {
+    using F = float;
+    using M = bool;
+
+    static constexpr int W = 1;
+
+    static F load(const float * p)     { return *p; }
+    static void store(float * p, F v)  { *p = v; }
+    static F set1(float v)             { return v; }
+
+    static F add(F a, F b)  { return a + b; }
+    static F sub(F a, F b)  { return a - b; }
+    static F mul(F a, F b)  { return a * b; }
+    static F div(F a, F b)  { return a / b; }
+    static F sqrt(F a)      { return std::sqrt(a); }
+    static F neg(F a)       { return -a; }
+    static F min(F a, F b)  { return a < b ? a : b; }
+
+    static M gt(F a, F b)   { return a > b; }
+    static F select(M m, F a, F b) { return m ? a : b; }
+};
+
+#if defined(IMGUI_DRAW_SIMD_SSE2)
+struct VecSSE2 {
+    using F = __m128;
+    using M = __m128;
+
+    static constexpr int W = 4;
+
+    static F load(const float * p)     { return _mm_loadu_ps(p); }
+    static void store(float * p, F v)  { _mm_storeu_ps(p, v); }
+    static F set1(float v)             { return _mm_set1_ps(v); }
+
+    static F add(F a, F b)  { return _mm_add_ps(a, b); }
+    static F sub(F a, F b)  { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b)  { return _mm_mul_ps(a, b); }
+    static F div(F a, F b)  { return _mm_div_ps(a, b); }
+    static F sqrt(F a)      { return _mm_sqrt_ps(a); }
+    static F neg(F a)       { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    static F min(F a, F b)  { return _mm_min_ps(a, b); } // a < b ? a : b
+
+    static M gt(F a, F b)   { return _mm_cmpgt_ps(a, b); }
+    static F select(M m, F a, F b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+#endif
+
+#if defined(__AVX2__)
+struct VecAVX2 {
+    using F = __m256;
+    using M = __m256;
+
+    static constexpr int W = 8;
+
+    static F load(const float * p)     { return _mm256_loadu_ps(p); }
+    static void store(float * p, F v)  { _mm256_storeu_ps(p, v); }
+    static F set1(float v)             { return _mm256_set1_ps(v); }
+
+    static F add(F a, F b)  { return _mm256_add_ps(a, b); }
+    static F sub(F a, F b)  { return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b)  { return _mm256_mul_ps(a, b); }
+    static F div(F a, F b)  { return _mm256_div_ps(a, b); }
+    static F sqrt(F a)      { return _mm256_sqrt_ps(a); }
+    static F neg(F a)       { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    static F min(F a, F b)  { return _mm256_min_ps(a, b); } // a < b ? a : b
+
+    static M gt(F a, F b)   { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+};
+#endif
+
+//
+// kernels - the arrays must be readable and writable kSimdPad elements past n
+//
+
+// x = cx + r*ux - the points of a circle
+template <typename V>
+void circlePoints(float cx, float cy, float r, const float * ux, const float * uy, int n, float * px, float * py) {
+    const auto vcx = V::set1(cx);
+    const auto vcy = V::set1(cy);
+    const auto vr  = V::set1(r);
+
+    for (int i = 0; i < n; i += V::W) {
+        V::store(px + i, V::add(vcx, V::mul(vr, V::load(ux + i))));
+        V::store(py + i, V::add(vcy, V::mul(vr, V::load(uy + i))));
+    }
+}
+
+// normal of each edge a[i] -> b[i], rotated by 90 degrees - as IM_NORMALIZE2F_OVER_ZERO()
+template <typename V>
+void edgeNormals(const float * ax, const float * ay, const float * bx, const float * by, int n, float * nx, float * ny) {
+    const auto zero = V::set1(0.0f);
+    const auto one  = V::set1(1.0f);
+
+    for (int i = 0; i < n; i += V::W) {
+        auto dx = V::sub(V::load(bx + i), V::load(ax + i));
+        auto dy = V::sub(V::load(by + i), V::load(ay + i));
+
+        const auto d2 = V::add(V::mul(dx, dx), V::mul(dy, dy));
+        const auto invLen = V::div(one, V::sqrt(d2));
+        const auto isNonZero = V::gt(d2, zero);
+
+        dx = V::select(isNonZero, V::mul(dx, invLen), dx);
+        dy = V::select(isNonZero, V::mul(dy, invLen), dy);
+
+        V::store(nx + i, dy);
+        V::store(ny + i, V::neg(dx));
+    }
+}
+
+// normal of each vertex from the normals of the edges before (a) and after (b) it - as IM_FIXNORMAL2F(), scaled
+template <typename V>
+void vertexNormals(const float * ax, const float * ay, const float * bx, const float * by, int n, float scale, float * dmx, float * dmy) {
+    const auto half   = V::set1(0.5f);
+    const auto one    = V::set1(1.0f);
+    const auto eps    = V::set1(0.000001f);
+    const auto maxInv = V::set1(100.0f);
+    const auto vscale = V::set1(scale);
+
+    for (int i = 0; i < n; i += V::W) {
+        auto mx = V::mul(V::add(V::load(ax + i), V::load(bx + i)), half);
+        auto my = V::mul(V::add(V::load(ay + i), V::load(by + i)), half);
+
+        const auto d2 = V::add(V::mul(mx, mx), V::mul(my, my));
+        const auto invLen2 = V::min(V::div(one, d2), maxInv);
+        const auto isNonZero = V::gt(d2, eps);
+
+        mx = V::select(isNonZero, V::mul(mx, invLen2), mx);
+        my = V::select(isNonZero, V::mul(my, invLen2), my);
+
+        V::store(dmx + i, V::mul(mx, vscale));
+        V::store(dmy + i, V::mul(my, vscale));
+    }
+}
+
+//
+// vertex and index output - same layout as ImDrawList::AddConvexPolyFilled() and ImDrawList::AddPolyline()
+//
+
+struct Output {
+    ImDrawVert * vtx;
+    ImDrawIdx * idx;
+    unsigned int base;
+
+    ImVec2 uv;
+};
+
+Output beginOutput(ImDrawList * drawList, int nIdx, int nVtx) {
+    drawList->PrimReserve(nIdx, nVtx);
+
+    return { drawList->_VtxWritePtr, drawList->_IdxWritePtr, drawList->_VtxCurrentIdx, drawList->_Data->TexUvWhitePixel };
+}
+
+void endOutput(ImDrawList * drawList, const Output & out) {
+    drawList->_VtxWritePtr = out.vtx;
+    drawList->_IdxWritePtr = out.idx;
+    drawList->_VtxCurrentIdx = out.base;
+}
+
+// (n - 2)*3 + n*6 indices, 2*n vertices
+void writeFillAA(Output & out, int n, const float * px, const float * py, const float * dmx, const float * dmy, ImU32 col) {
+    const ImU32 colTrans = col & ~IM_COL32_A_MASK;
+
+    const unsigned int inner = out.base;
+    const unsigned int outer = out.base + 1;
+
+    for (int i = 2; i < n; ++i) {
+        out.idx[0] = (ImDrawIdx) (inner);
+        out.idx[1] = (ImDrawIdx) (inner + ((i - 1) << 1));
+        out.idx[2] = (ImDrawIdx) (inner + (i << 1));
+        out.idx += 3;
+    }
+
+    for (int i0 = n - 1, i1 = 0; i1 < n; i0 = i1++) {
+        out.vtx[0].pos.x = px[i1] - dmx[i1];
+        out.vtx[0].pos.y = py[i1] - dmy[i1];
+        out.vtx[0].uv = out.uv;
+        out.vtx[0].col = col;
+
+        out.vtx[1].pos.x = px[i1] + dmx[i1];
+        out.vtx[1].pos.y = py[i1] + dmy[i1];
+        out.vtx[1].uv = out.uv;
+        out.vtx[1].col = colTrans;
+
+        out.vtx += 2;
+
+        out.idx[0] = (ImDrawIdx) (inner + (i1 << 1));
+        out.idx[1] = (ImDrawIdx) (inner + (i0 << 1));
+        out.idx[2] = (ImDrawIdx) (outer + (i0 << 1));
+        out.idx[3] = (ImDrawIdx) (outer + (i0 << 1));
+        out.idx[4] = (ImDrawIdx) (outer + (i1 << 1));
+        out.idx[5] = (ImDrawIdx) (inner + (i1 << 1));
+        out.idx += 6;
+    }
+
+    out.base += 2*n;
+}
+
+int strokeVtxCount(int n, bool isThick)          { return n*(isThick ? 4 : 3); }
+int strokeIdxCount(int nSegments, bool isThick)  { return nSegments*(isThick ? 18 : 12); }
+
+// thin: the normals are scaled by the fringe - the center at the full color and one transparent vertex on each side
+// thick: unit normals - two vertices at the full color at halfInner from the center and two transparent ones outside
+void writeStrokeAA(Output & out, int n, bool isClosed, const float * px, const float * py, const float * dmx, const float * dmy,
+                   ImU32 col, bool isThick, float halfInner, float aaSize) {
+    const ImU32 colTrans = col & ~IM_COL32_A_MASK;
+
+    const unsigned int base = out.base;
+    const int nSegments = isClosed ? n : n - 1;
+
+    if (isThick) {
+        const float scaleOut = halfInner + aaSize;
+
+        for (int i = 0; i < n; ++i) {
+            const float outX = dmx[i]*scaleOut;
+            const float outY = dmy[i]*scaleOut;
+            const float inX  = dmx[i]*halfInner;
+            const float inY  = dmy[i]*halfInner;
+
+            out.vtx[0].pos.x = px[i] + outX; out.vtx[0].pos.y = py[i] + outY; out.vtx[0].uv = out.uv; out.vtx[0].col = colTrans;
+            out.vtx[1].pos.x = px[i] + inX;  out.vtx[1].pos.y = py[i] + inY;  out.vtx[1].uv = out.uv; out.vtx[1].col = col;
+            out.vtx[2].pos.x = px[i] - inX;  out.vtx[2].pos.y = py[i] - inY;  out.vtx[2].uv = out.uv; out.vtx[2].col = col;
+            out.vtx[3].pos.x = px[i] - outX; out.vtx[3].pos.y = py[i] - outY; out.vtx[3].uv = out.uv; out.vtx[3].col = colTrans;
+            out.vtx += 4;
+        }
+
+        for (int i1 = 0; i1 < nSegments; ++i1) {
+            const int i2 = (i1 + 1) == n ? 0 : i1 + 1;
+
+            const unsigned int idx1 = base + 4*i1;
+            const unsigned int idx2 = base + 4*i2;
+
+            out.idx[0]  = (ImDrawIdx) (idx2 + 1); out.idx[1]  = (ImDrawIdx) (idx1 + 1); out.idx[2]  = (ImDrawIdx) (idx1 + 2);
+            out.idx[3]  = (ImDrawIdx) (idx1 + 2); out.idx[4]  = (ImDrawIdx) (idx2 + 2); out.idx[5]  = (ImDrawIdx) (idx2 + 1);
+            out.idx[6]  = (ImDrawIdx) (idx2 + 1); out.idx[7]  = (ImDrawIdx) (idx1 + 1); out.idx[8]  = (ImDrawIdx) (idx1 + 0);
+            out.idx[9]  = (ImDrawIdx) (idx1 + 0); out.idx[10] = (ImDrawIdx) (idx2 + 0); out.idx[11] = (ImDrawIdx) (idx2 + 1);
+            out.idx[12] = (ImDrawIdx) (idx2 + 2); out.idx[13] = (ImDrawIdx) (idx1 + 2); out.idx[14] = (ImDrawIdx) (idx1 + 3);
+            out.idx[15] = (ImDrawIdx) (idx1 + 3); out.idx[16] = (ImDrawIdx) (idx2 + 3); out.idx[17] = (ImDrawIdx) (idx2 + 2);
+            out.idx += 18;
+        }
+    } else {
+        for (int i = 0; i < n; ++i) {
+            out.vtx[0].pos.x = px[i];          out.vtx[0].pos.y = py[i];          out.vtx[0].uv = out.uv; out.vtx[0].col = col;
+            out.vtx[1].pos.x = px[i] + dmx[i]; out.vtx[1].pos.y = py[i] + dmy[i]; out.vtx[1].uv = out.uv; out.vtx[1].col = colTrans;
+            out.vtx[2].pos.x = px[i] - dmx[i]; out.vtx[2].pos.y = py[i] - dmy[i]; out.vtx[2].uv = out.uv; out.vtx[2].col = colTrans;
+            out.vtx += 3;
+        }
+
+        for (int i1 = 0; i1 < nSegments; ++i1) {
+            const int i2 = (i1 + 1) == n ? 0 : i1 + 1;
+
+            const unsigned int idx1 = base + 3*i1;
+            const unsigned int idx2 = base + 3*i2;
+
+            out.idx[0]  = (ImDrawIdx) (idx2 + 0); out.idx[1]  = (ImDrawIdx) (idx1 + 0); out.idx[2]  = (ImDrawIdx) (idx1 + 2);
+            out.idx[3]  = (ImDrawIdx) (idx1 + 2); out.idx[4]  = (ImDrawIdx) (idx2 + 2); out.idx[5]  = (ImDrawIdx) (idx2 + 0);
+            out.idx[6]  = (ImDrawIdx) (idx2 + 1); out.idx[7]  = (ImDrawIdx) (idx1 + 1); out.idx[8]  = (ImDrawIdx) (idx1 + 0);
+            out.idx[9]  = (ImDrawIdx) (idx1 + 0); out.idx[10] = (ImDrawIdx) (idx2 + 0); out.idx[11] = (ImDrawIdx) (idx2 + 1);
+            out.idx += 12;
+        }
+    }
+
+    out.base += strokeVtxCount(n, isThick);
+}
+
+//
+// primitives
+//
+
+// nArrays arrays of n elements, padded
+float * getScratch(int nArrays, int n, int & stride) {
+    stride = n + 2*kSimdPad;
+
+    return ImGui_GetDrawSimdScratch(nArrays*stride);
+}
+
+int circleSegmentCount(const ImDrawList * drawList, float radius, int numSegments) {
+    if (numSegments > 0) {
+        return ImClamp(numSegments, 3, IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX);
+    }
+
+    return drawList->_CalcCircleAutoSegmentCount(radius);
+}
+
+template <typename V>
+void addCirclesFilled(ImDrawList * drawList, const ImGuiCircle * circles, int count, int numSegments) {
+    if ((drawList->Flags & ImDrawListFlags_AntiAliasedFill) == 0) {
+        for (int i = 0; i < count; ++i) {
+            drawList->AddCircleFilled(circles[i].center, circles[i].radius, circles[i].col, numSegments);
+        }
+        return;
+    }
+
+    int * segments = ImGui_GetDrawSimdScratchInt(count);
+
+    int nIdx = 0;
+    int nVtx = 0;
+    int nMax = 0;
+
+    for (int i = 0; i < count; ++i) {
+        const auto & circle = circles[i];
+        if ((circle.col & IM_COL32_A_MASK) == 0 || circle.radius < 0.5f) {
+            segments[i] = 0;
+            continue;
+        }
+
+        const int n = circleSegmentCount(drawList, circle.radius, numSegments);
+
+        segments[i] = n;
+        nIdx += (n - 2)*3 + n*6;
+        nVtx += 2*n;
+        nMax = ImMax(nMax, n);
+    }
+
+    if (nVtx == 0) {
+        return;
+    }
+
+    // points, edge normals (starting with the one before the first point), vertex normals
+    int stride = 0;
+    float * buf = getScratch(6, nMax + 1, stride);
+    float * px  = buf;
+    float * py  = buf + 1*stride;
+    float * ex  = buf + 2*stride;
+    float * ey  = buf + 3*stride;
+    float * dmx = buf + 4*stride;
+    float * dmy = buf + 5*stride;
+
+    const float aaSize = drawList->_FringeScale;
+
+    auto out = beginOutput(drawList, nIdx, nVtx);
+
+    for (int i = 0; i < count; ++i) {
+        const int n = segments[i];
+        if (n == 0) {
+            continue;
+        }
+
+        const auto & circle = circles[i];
+        const auto unit = ImGui_GetCircleTable(n);
+
+        // n + 1 points - the last one is the first one again
+        circlePoints<V>(circle.center.x, circle.center.y, circle.radius, unit.x, unit.y, n + 1, px, py);
+
+        edgeNormals<V>(px, py, px + 1, py + 1, n, ex + 1, ey + 1);
+        ex[0] = ex[n];
+        ey[0] = ey[n];
+
+        vertexNormals<V>(ex, ey, ex + 1, ey + 1, n, aaSize*0.5f, dmx, dmy);
+
+        writeFillAA(out, n, px, py, dmx, dmy, circle.col);
+    }
+
+    endOutput(drawList, out);
+}
+
+template <typename V>
+void addConvexPolyFilled(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col) {
+    if ((drawList->Flags & ImDrawListFlags_AntiAliasedFill) == 0) {
+        drawList->AddConvexPolyFilled(points, count, col);
+        return;
+    }
+
+    if (count < 3 || (col & IM_COL32_A_MASK) == 0) {
+        return;
+    }
+
+    const int n = count;
+
+    int stride = 0;
+    float * buf = getScratch(6, n + 1, stride);
+    float * px  = buf;
+    float * py  = buf + 1*stride;
+    float * ex  = buf + 2*stride;
+    float * ey  = buf + 3*stride;
+    float * dmx = buf + 4*stride;
+    float * dmy = buf + 5*stride;
+
+    for (int i = 0; i < n; ++i) {
+        px[i] = points[i].x;
+        py[i] = points[i].y;
+    }
+    px[n] = px[0];
+    py[n] = py[0];
+
+    edgeNormals<V>(px, py, px + 1, py + 1, n, ex + 1, ey + 1);
+    ex[0] = ex[n];
+    ey[0] = ey[n];
+
+    vertexNormals<V>(ex, ey, ex + 1, ey + 1, n, drawList->_FringeScale*0.5f, dmx, dmy);
+
+    auto out = beginOutput(drawList, (n - 2)*3 + n*6, 2*n);
+    writeFillAA(out, n, px, py, dmx, dmy, col);
+    endOutput(drawList, out);
+}
+
+template <typename V>
+void addPolyline(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col, ImDrawFlags flags, float thickness) {
+    if ((drawList->Flags & ImDrawListFlags_AntiAliasedLines) == 0) {
+        drawList->AddPolyline(points, count, col, flags, thickness);
+        return;
+    }
+
+    if (count < 2 || (col & IM_COL32_A_MASK) == 0) {
+        return;
+    }
+
+    const int n = count;
+    const bool isClosed = (flags & ImDrawFlags_Closed) != 0;
+
+    const float aaSize = drawList->_FringeScale;
+
+    thickness = ImMax(thickness, 1.0f);
+    const bool isThick = thickness > aaSize;
+
+    int stride = 0;
+    float * buf = getScratch(6, n + 1, stride);
+    float * px  = buf;
+    float * py  = buf + 1*stride;
+    float * ex  = buf + 2*stride;
+    float * ey  = buf + 3*stride;
+    float * dmx = buf + 4*stride;
+    float * dmy = buf + 5*stride;
+
+    for (int i = 0; i < n; ++i) {
+        px[i] = points[i].x;
+        py[i] = points[i].y;
+    }
+    px[n] = px[0];
+    py[n] = py[0];
+
+    edgeNormals<V>(px, py, px + 1, py + 1, n, ex + 1, ey + 1);
+    if (isClosed) {
+        ex[0] = ex[n];
+        ey[0] = ey[n];
+    } else {
+        // the end points only have one edge
+        ex[0] = ex[1];
+        ey[0] = ey[1];
+        ex[n] = ex[n - 1];
+        ey[n] = ey[n - 1];
+    }
+
+    vertexNormals<V>(ex, ey, ex + 1, ey + 1, n, isThick ? 1.0f : aaSize, dmx, dmy);
+
+    const int nSegments = isClosed ? n : n - 1;
+
+    auto out = beginOutput(drawList, strokeIdxCount(nSegments, isThick), strokeVtxCount(n, isThick));
+    writeStrokeAA(out, n, isClosed, px, py, dmx, dmy, col, isThick, (thickness - aaSize)*0.5f, aaSize);
+    endOutput(drawList, out);
+}
+
+template <typename V>
+void addLines(ImDrawList * drawList, const ImVec2 * points, int count, ImU32 col, float thickness) {
+    if ((drawList->Flags & ImDrawListFlags_AntiAliasedLines) == 0) {
+        for (int i = 0; i < count; ++i) {
+            drawList->AddLine(points[2*i], points[2*i + 1], col, thickness);
+        }
+        return;
+    }
+
+    if (count < 1 || (col & IM_COL32_A_MASK) == 0) {
+        return;
+    }
+
+    const int n = count;
+
+    const float aaSize = drawList->_FringeScale;
+
+    thickness = ImMax(thickness, 1.0f);
+    const bool isThick = thickness > aaSize;
+
+    // the end points of all lines, their normals and the normals of the vertices
+    int stride = 0;
+    float * buf = getScratch(8, n, stride);
+    float * ax  = buf;
+    float * ay  = buf + 1*stride;
+    float * bx  = buf + 2*stride;
+    float * by  = buf + 3*stride;
+    float * nx  = buf + 4*stride;
+    float * ny  = buf + 5*stride;
+    float * dmx = buf + 6*stride;
+    float * dmy = buf + 7*stride;
+
+    // the same offset as ImDrawList::AddLine()
+    for (int i = 0; i < n; ++i) {
+        ax[i] = points[2*i + 0].x + 0.5f;
+        ay[i] = points[2*i + 0].y + 0.5f;
+        bx[i] = points[2*i + 1].x + 0.5f;
+        by[i] = points[2*i + 1].y + 0.5f;
+    }
+
+    edgeNormals<V>(ax, ay, bx, by, n, nx, ny);
+    vertexNormals<V>(nx, ny, nx, ny, n, isThick ? 1.0f : aaSize, dmx, dmy);
+
+    const float halfInner = (thickness - aaSize)*0.5f;
+
+    auto out = beginOutput(drawList, n*strokeIdxCount(1, isThick), n*strokeVtxCount(2, isThick));
+    for (int i = 0; i < n; ++i) {
+        const float lx[2] = { ax[i], bx[i] };
+        const float ly[2] = { ay[i], by[i] };
+        const float lmx[2] = { dmx[i], dmx[i] };
+        const float lmy[2] = { dmy[i], dmy[i] };
+
+        writeStrokeAA(out, 2, false, lx, ly, lmx, lmy, col, isThick, halfInner, aaSize);
+    }
+    endOutput(drawList, out);
+}
+
+template <typename V>
+const ImGuiDrawSimdKernels & getKernels() {
+    static const ImGuiDrawSimdKernels kernels = {
+        addCirclesFilled<V>,
+        addLines<V>,
+        addPolyline<V>,
+        addConvexPolyFilled<V>,
+    };
+
+    return kernels;
+}
+
+}
@@ -1,9 +1,1106 @@
 #include "imgui-extra/imgui_impl.h"
+#include "imgui-extra/imgui_alloc.h"
 
 #include "imgui/backends/imgui_impl_sdl.h"
 #include "imgui/backends/imgui_impl_opengl3.h"
 
 #include <SDL.h>
+#include <SDL_opengl.h>
+
+#include <atomic>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace {
+
+// the GLSL version selected in ImGui_Init()
+const char* g_GlslVersion = nullptr;
+
+//
+// SDF text
+//
+// the stock OpenGL3 backend does not allow changing the shader, so the draw lists are patched before rendering:
+// a callback switching to the SDF program is inserted before each run of commands that sample the font texture
+// and ImDrawCallback_ResetRenderState brings back the stock program after it
+//
+
+struct SDFState {
+    bool enabled = false;
+    bool failed = false;
+
+    GLuint program = 0;
+    GLint locTexture = -1;
+    GLint locProjMtx = -1;
+
+    const ImDrawData* drawData = nullptr;
+
+    // the shader functions are not part of OpenGL 1.1, so we load them at runtime
+    PFNGLCREATESHADERPROC       createShader       = nullptr;
+    PFNGLSHADERSOURCEPROC       shaderSource       = nullptr;
+    PFNGLCOMPILESHADERPROC      compileShader      = nullptr;
+    PFNGLGETSHADERIVPROC        getShaderiv        = nullptr;
+    PFNGLGETSHADERINFOLOGPROC   getShaderInfoLog   = nullptr;
+    PFNGLDELETESHADERPROC       deleteShader       = nullptr;
+    PFNGLCREATEPROGRAMPROC      createProgram      = nullptr;
+    PFNGLATTACHSHADERPROC       attachShader       = nullptr;
+    PFNGLDETACHSHADERPROC       detachShader       = nullptr;
+    PFNGLBINDATTRIBLOCATIONPROC bindAttribLocation = nullptr;
+    PFNGLLINKPROGRAMPROC        linkProgram        = nullptr;
+    PFNGLGETPROGRAMIVPROC       getProgramiv       = nullptr;
+    PFNGLDELETEPROGRAMPROC      deleteProgram      = nullptr;
+    PFNGLUSEPROGRAMPROC         useProgram         = nullptr;
+    PFNGLGETATTRIBLOCATIONPROC  getAttribLocation  = nullptr;
+    PFNGLGETUNIFORMLOCATIONPROC getUniformLocation = nullptr;
+    PFNGLUNIFORM1IPROC          uniform1i          = nullptr;
+    PFNGLUNIFORMMATRIX4FVPROC   uniformMatrix4fv   = nullptr;
+
+    bool load() {
+        createShader       = (PFNGLCREATESHADERPROC)       SDL_GL_GetProcAddress("glCreateShader");
+        shaderSource       = (PFNGLSHADERSOURCEPROC)       SDL_GL_GetProcAddress("glShaderSource");
+        compileShader      = (PFNGLCOMPILESHADERPROC)      SDL_GL_GetProcAddress("glCompileShader");
+        getShaderiv        = (PFNGLGETSHADERIVPROC)        SDL_GL_GetProcAddress("glGetShaderiv");
+        getShaderInfoLog   = (PFNGLGETSHADERINFOLOGPROC)   SDL_GL_GetProcAddress("glGetShaderInfoLog");
+        deleteShader       = (PFNGLDELETESHADERPROC)       SDL_GL_GetProcAddress("glDeleteShader");
+        createProgram      = (PFNGLCREATEPROGRAMPROC)      SDL_GL_GetProcAddress("glCreateProgram");
+        attachShader       = (PFNGLATTACHSHADERPROC)       SDL_GL_GetProcAddress("glAttachShader");
+        detachShader       = (PFNGLDETACHSHADERPROC)       SDL_GL_GetProcAddress("glDetachShader");
+        bindAttribLocation = (PFNGLBINDATTRIBLOCATIONPROC) SDL_GL_GetProcAddress("glBindAttribLocation");
+        linkProgram        = (PFNGLLINKPROGRAMPROC)        SDL_GL_GetProcAddress("glLinkProgram");
+        getProgramiv       = (PFNGLGETPROGRAMIVPROC)       SDL_GL_GetProcAddress("glGetProgramiv");
+        deleteProgram      = (PFNGLDELETEPROGRAMPROC)      SDL_GL_GetProcAddress("glDeleteProgram");
+        useProgram         = (PFNGLUSEPROGRAMPROC)         SDL_GL_GetProcAddress("glUseProgram");
+        getAttribLocation  = (PFNGLGETATTRIBLOCATIONPROC)  SDL_GL_GetProcAddress("glGetAttribLocation");
+        getUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC) SDL_GL_GetProcAddress("glGetUniformLocation");
+        uniform1i          = (PFNGLUNIFORM1IPROC)          SDL_GL_GetProcAddress("glUniform1i");
+        uniformMatrix4fv   = (PFNGLUNIFORMMATRIX4FVPROC)   SDL_GL_GetProcAddress("glUniformMatrix4fv");
+
+        return createShader && shaderSource && compileShader && getShaderiv && getShaderInfoLog && deleteShader &&
+            createProgram && attachShader && detachShader && bindAttribLocation && linkProgram && getProgramiv &&
+            deleteProgram && useProgram && getAttribLocation && getUniformLocation && uniform1i && uniformMatrix4fv;
+    }
+} g_SDF;
+
+// same inputs as the stock shaders - only the alpha of the texture is interpreted differently
+const char* kVertexShader_100 =
+    "uniform mat4 ProjMtx;\n"
+    "attribute vec2 Position;\n"
+    "attribute vec2 UV;\n"
+    "attribute vec4 Color;\n"
+    "varying vec2 Frag_UV;\n"
+    "varying vec4 Frag_Color;\n"
+    "void main() {\n"
+    "    Frag_UV = UV;\n"
+    "    Frag_Color = Color;\n"
+    "    gl_Position = ProjMtx * vec4(Position.xy, 0, 1);\n"
+    "}\n";
+
+const char* kSDFFragmentShader_100 =
+    "#extension GL_OES_standard_derivatives : enable\n"
+    "precision mediump float;\n"
+    "uniform sampler2D Texture;\n"
+    "varying vec2 Frag_UV;\n"
+    "varying vec4 Frag_Color;\n"
+    "void main() {\n"
+    "    float d = texture2D(Texture, Frag_UV.st).a;\n"
+    "    float w = max(fwidth(d), 1e-4);\n"
+    "    gl_FragColor = vec4(Frag_Color.rgb, Frag_Color.a * smoothstep(0.5 - w, 0.5 + w, d));\n"
+    "}\n";
+
+const char* kVertexShader_130 =
+    "uniform mat4 ProjMtx;\n"
+    "in vec2 Position;\n"
+    "in vec2 UV;\n"
+    "in vec4 Color;\n"
+    "out vec2 Frag_UV;\n"
+    "out vec4 Frag_Color;\n"
+    "void main() {\n"
+    "    Frag_UV = UV;\n"
+    "    Frag_Color = Color;\n"
+    "    gl_Position = ProjMtx * vec4(Position.xy, 0, 1);\n"
+    "}\n";
+
+const char* kSDFFragmentShader_130 =
+    "uniform sampler2D Texture;\n"
+    "in vec2 Frag_UV;\n"
+    "in vec4 Frag_Color;\n"
+    "out vec4 Out_Color;\n"
+    "void main() {\n"
+    "    float d = texture(Texture, Frag_UV.st).a;\n"
+    "    float w = max(fwidth(d), 1e-4);\n"
+    "    Out_Color = vec4(Frag_Color.rgb, Frag_Color.a * smoothstep(0.5 - w, 0.5 + w, d));\n"
+    "}\n";
+
+GLuint compileShader(GLenum type, const char* source) {
+    const bool isES = strstr(g_GlslVersion, " es") != nullptr;
+    const char* sources[3] = { g_GlslVersion, isES && type == GL_FRAGMENT_SHADER ? "\nprecision mediump float;\n" : "\n", source, };
+
+    GLuint shader = g_SDF.createShader(type);
+    g_SDF.shaderSource(shader, 3, sources, nullptr);
+    g_SDF.compileShader(shader);
+
+    GLint status = 0;
+    g_SDF.getShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE) {
+        char log[1024] = {};
+        g_SDF.getShaderInfoLog(shader, sizeof(log), nullptr, log);
+        fprintf(stderr, "Error: failed to compile SDF shader:\n%s\n", log);
+        g_SDF.deleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+bool isLegacyGlsl() {
+    return strstr(g_GlslVersion, "100") != nullptr;
+}
+
+// the attributes "Position", "UV" and "Color" are bound to the given locations (negative - not bound)
+GLuint createProgram(const char* vsSource, const char* fsSource, const GLint locations[3]) {
+    const GLuint vs = compileShader(GL_VERTEX_SHADER,   vsSource);
+    const GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSource);
+    if (vs == 0 || fs == 0) {
+        if (vs) g_SDF.deleteShader(vs);
+        if (fs) g_SDF.deleteShader(fs);
+        return 0;
+    }
+
+    GLuint program = g_SDF.createProgram();
+    g_SDF.attachShader(program, vs);
+    g_SDF.attachShader(program, fs);
+
+    const char* attributes[] = { "Position", "UV", "Color", };
+    for (int i = 0; i < 3; ++i) {
+        if (locations[i] >= 0) {
+            g_SDF.bindAttribLocation(program, locations[i], attributes[i]);
+        }
+    }
+
+    g_SDF.linkProgram(program);
+
+    g_SDF.detachShader(program, vs);
+    g_SDF.detachShader(program, fs);
+    g_SDF.deleteShader(vs);
+    g_SDF.deleteShader(fs);
+
+    GLint status = 0;
+    g_SDF.getProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        fprintf(stderr, "Error: failed to link shader program\n");
+        g_SDF.deleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+// called with the stock program in use - the attribute locations of the SDF program have to match it,
+// since the vertex layout has already been set up by the backend
+bool createSDFProgram() {
+    if (g_SDF.load() == false) {
+        fprintf(stderr, "Error: failed to load the OpenGL shader functions\n");
+        return false;
+    }
+
+    GLint programStock = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &programStock);
+
+    const GLint locations[3] = {
+        g_SDF.getAttribLocation(programStock, "Position"),
+        g_SDF.getAttribLocation(programStock, "UV"),
+        g_SDF.getAttribLocation(programStock, "Color"),
+    };
+
+    g_SDF.program = createProgram(isLegacyGlsl() ? kVertexShader_100   : kVertexShader_130,
+                                  isLegacyGlsl() ? kSDFFragmentShader_100 : kSDFFragmentShader_130, locations);
+    if (g_SDF.program == 0) {
+        return false;
+    }
+
+    g_SDF.locTexture = g_SDF.getUniformLocation(g_SDF.program, "Texture");
+    g_SDF.locProjMtx = g_SDF.getUniformLocation(g_SDF.program, "ProjMtx");
+
+    return true;
+}
+
+// same projection as the stock backend
+void getProjection(const ImDrawData* draw_data, float ortho[4][4]) {
+    const float L = draw_data->DisplayPos.x;
+    const float R = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
+    const float T = draw_data->DisplayPos.y;
+    const float B = draw_data->DisplayPos.y + draw_data->DisplaySize.y;
+    const float res[4][4] = {
+        { 2.0f/(R - L),      0.0f,              0.0f, 0.0f },
+        { 0.0f,              2.0f/(T - B),      0.0f, 0.0f },
+        { 0.0f,              0.0f,             -1.0f, 0.0f },
+        { (R + L)/(L - R),   (T + B)/(B - T),   0.0f, 1.0f },
+    };
+
+    memcpy(ortho, res, sizeof(res));
+}
+
+void useSDFProgram(const ImDrawList* , const ImDrawCmd* ) {
+    if (g_SDF.program == 0 && g_SDF.failed == false) {
+        g_SDF.failed = createSDFProgram() == false;
+    }
+
+    // fallback to the stock program - the text will look blurry, but it is still readable
+    if (g_SDF.program == 0) {
+        return;
+    }
+
+    float ortho[4][4];
+    getProjection(g_SDF.drawData, ortho);
+
+    g_SDF.useProgram(g_SDF.program);
+    g_SDF.uniform1i(g_SDF.locTexture, 0);
+    g_SDF.uniformMatrix4fv(g_SDF.locProjMtx, 1, GL_FALSE, &ortho[0][0]);
+}
+
+// insert the program switches around the commands that sample the font texture
+// the commands are patched in place, so nothing is allocated when the capacity of the command buffers is at least
+// ImGui_GetRenderCmdCapacity() - the render thread must not allocate (see RenderThread::submit())
+void patchDrawData(ImDrawData* draw_data) {
+    const ImTextureID texFont = ImGui::GetIO().Fonts->TexID;
+
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        ImDrawList* list = draw_data->CmdLists[n];
+
+        // the number of switches
+        int nSwitches = 0;
+        bool isSDF = false;
+        for (const ImDrawCmd& cmd : list->CmdBuffer) {
+            if (cmd.UserCallback != nullptr) {
+                isSDF = false;
+                continue;
+            }
+
+            const bool isFont = cmd.TextureId == texFont;
+            if (isFont != isSDF) {
+                ++nSwitches;
+                isSDF = isFont;
+            }
+        }
+
+        // the next list starts with the stock program
+        if (isSDF) {
+            ++nSwitches;
+        }
+
+        if (nSwitches == 0) {
+            continue;
+        }
+
+        // move the commands to the end and write them back from the start - the write position never passes the
+        // read position, since it trails it by the number of switches that are still to be inserted
+        const int nCmds = list->CmdBuffer.Size;
+        list->CmdBuffer.reserve(ImGui_GetRenderCmdCapacity(nCmds));
+        list->CmdBuffer.resize(nCmds + nSwitches);
+
+        ImDrawCmd* cmds = list->CmdBuffer.Data;
+        memmove(cmds + nSwitches, cmds, nCmds*sizeof(ImDrawCmd));
+
+        int nOut = 0;
+        isSDF = false;
+        for (int i = nSwitches; i < nCmds + nSwitches; ++i) {
+            const ImDrawCmd cmd = cmds[i];
+
+            if (cmd.UserCallback != nullptr) {
+                // the state after a user callback is unknown
+                cmds[nOut++] = cmd;
+                isSDF = false;
+                continue;
+            }
+
+            const bool isFont = cmd.TextureId == texFont;
+            if (isFont != isSDF) {
+                ImDrawCmd cmdSwitch = cmd;
+                cmdSwitch.ElemCount = 0;
+                cmdSwitch.UserCallback = isFont ? useSDFProgram : ImDrawCallback_ResetRenderState;
+                cmdSwitch.UserCallbackData = nullptr;
+                cmds[nOut++] = cmdSwitch;
+
+                isSDF = isFont;
+            }
+
+            cmds[nOut++] = cmd;
+        }
+
+        if (isSDF) {
+            ImDrawCmd cmdSwitch = cmds[nOut - 1];
+            cmdSwitch.ElemCount = 0;
+            cmdSwitch.UserCallback = ImDrawCallback_ResetRenderState;
+            cmdSwitch.UserCallbackData = nullptr;
+            cmds[nOut++] = cmdSwitch;
+        }
+    }
+}
+
+//
+// batching
+//
+// ImGui merges the adjacent commands of a list only when their clip rects are exactly the same, so for example
+// a popup whose clip rect extends past the display still breaks the batch of the window below it
+// the clip rects are clamped to the display, which does not change the scissor, and then the adjacent commands
+// with the same texture, clip rect and vertex offset, whose indices follow each other, are merged into one
+// the commands are not reordered across each other, since ImGui relies on the order for the overlapping windows
+//
+
+struct BatchState {
+    // last frame - read from other threads
+    std::atomic<int> nCmds { 0 };
+    std::atomic<int> nDrawCalls { 0 };
+    std::atomic<int> nStateChanges { 0 };
+} g_Batch;
+
+bool isSameClipRect(const ImVec4& a, const ImVec4& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+void batchDrawData(ImDrawData* draw_data) {
+    const ImVec2 pmin = draw_data->DisplayPos;
+    const ImVec2 pmax = ImVec2(pmin.x + draw_data->DisplaySize.x, pmin.y + draw_data->DisplaySize.y);
+
+    int nCmds = 0;
+    int nDrawCalls = 0;
+
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        ImDrawList* list = draw_data->CmdLists[n];
+
+        // compacted in place - the merged commands are never ahead of the ones that are read
+        int nOut = 0;
+        for (int i = 0; i < list->CmdBuffer.Size; ++i) {
+            ImDrawCmd cmd = list->CmdBuffer[i];
+
+            if (cmd.UserCallback != nullptr) {
+                list->CmdBuffer[nOut++] = cmd;
+                continue;
+            }
+
+            ++nCmds;
+
+            cmd.ClipRect.x = std::max(cmd.ClipRect.x, pmin.x);
+            cmd.ClipRect.y = std::max(cmd.ClipRect.y, pmin.y);
+            cmd.ClipRect.z = std::min(cmd.ClipRect.z, pmax.x);
+            cmd.ClipRect.w = std::min(cmd.ClipRect.w, pmax.y);
+
+            // nothing would be drawn
+            if (cmd.ElemCount == 0 || cmd.ClipRect.z <= cmd.ClipRect.x || cmd.ClipRect.w <= cmd.ClipRect.y) {
+                continue;
+            }
+
+            if (nOut > 0) {
+                ImDrawCmd& last = list->CmdBuffer[nOut - 1];
+                if (last.UserCallback == nullptr &&
+                    last.GetTexID() == cmd.GetTexID() &&
+                    last.VtxOffset == cmd.VtxOffset &&
+                    last.IdxOffset + last.ElemCount == cmd.IdxOffset &&
+                    isSameClipRect(last.ClipRect, cmd.ClipRect)) {
+                    last.ElemCount += cmd.ElemCount;
+                    continue;
+                }
+            }
+
+            list->CmdBuffer[nOut++] = cmd;
+            ++nDrawCalls;
+        }
+
+        list->CmdBuffer.resize(nOut);
+    }
+
+    g_Batch.nCmds = nCmds;
+    g_Batch.nDrawCalls = nDrawCalls;
+}
+
+//
+// streaming renderer
+//
+// replaces ImGui_ImplOpenGL3_RenderDrawData(), which uploads all vertex and index buffers with glBufferData() on
+// every frame - here the data is appended to two ring buffers and only the lists that have changed are uploaded:
+//  - with GL_ARB_buffer_storage (native), the rings are persistently mapped and written with memcpy()
+//  - otherwise (WebGL), the new data is written with glBufferSubData() and the buffers are orphaned when the rings
+//    wrap around
+// an unchanged list is drawn from its previous upload, as long as the rings have not wrapped around since then
+// the indices of each draw command are packed as 16-bit when its vertex range fits, even though ImDrawIdx is 32-bit
+// the stock renderer is used if the streaming renderer cannot be initialized
+//
+
+// offsets of the lists in the rings are aligned to this many bytes
+constexpr size_t kStreamAlign = 16;
+
+// the rings hold at least this many frames in which all lists change
+constexpr size_t kStreamFrames = 4;
+constexpr size_t kStreamMinSize = 256*1024;
+
+constexpr GLuint kAttribPosition = 0;
+constexpr GLuint kAttribUV       = 1;
+constexpr GLuint kAttribColor    = 2;
+
+const char* kFragmentShader_100 =
+    "precision mediump float;\n"
+    "uniform sampler2D Texture;\n"
+    "varying vec2 Frag_UV;\n"
+    "varying vec4 Frag_Color;\n"
+    "void main() {\n"
+    "    gl_FragColor = Frag_Color * texture2D(Texture, Frag_UV.st);\n"
+    "}\n";
+
+const char* kFragmentShader_130 =
+    "uniform sampler2D Texture;\n"
+    "in vec2 Frag_UV;\n"
+    "in vec4 Frag_Color;\n"
+    "out vec4 Out_Color;\n"
+    "void main() {\n"
+    "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+    "}\n";
+
+struct StreamRing {
+    GLenum target = 0;
+    GLuint buffer = 0;
+
+    size_t capacity = 0;
+    size_t head = 0;
+
+    // persistently mapped storage
+    uint8_t* mapped = nullptr;
+};
+
+// location of the indices of a draw command - baseVertex is added by offsetting the vertex attributes
+struct StreamCmd {
+    size_t idxOffset = 0;
+    uint32_t baseVertex = 0;
+    bool is16 = false;
+};
+
+// location of the last upload of a list
+struct StreamList {
+    uint64_t hash = 0;
+    uint32_t generation = 0;
+
+    int nVtx = 0;
+    int nIdx = 0;
+
+    size_t vtxOffset = 0;
+
+    std::vector<StreamCmd> cmds;
+};
+
+struct StreamState {
+    // read from other threads by ImGui_GetRenderStats()
+    std::atomic<bool> initialized { false };
+    std::atomic<bool> persistent { false };
+
+    bool failed = false;
+
+    GLuint vao = 0;
+
+    GLuint program = 0;
+    GLint locTexture = -1;
+    GLint locProjMtx = -1;
+
+    GLuint programSDF = 0;
+    GLint locTextureSDF = -1;
+    GLint locProjMtxSDF = -1;
+
+    StreamRing vtx;
+    StreamRing idx;
+
+    // incremented each time the contents of the rings are discarded
+    uint32_t generation = 1;
+
+    // the last frame that used the rings - waited for before overwriting them from the start
+    GLsync fence = nullptr;
+
+    std::vector<StreamList> lists;
+
+    // packed indices before glBufferSubData()
+    std::vector<uint8_t> scratch;
+
+    // stats of the last frame - read from other threads
+    std::atomic<int> nListsUploaded { 0 };
+    std::atomic<int> nListsSkipped { 0 };
+    std::atomic<int64_t> nBytesUploaded { 0 };
+    std::atomic<int> nCmdsIdx16 { 0 };
+    std::atomic<int> nCmdsIdx32 { 0 };
+
+    PFNGLGENBUFFERSPROC              genBuffers              = nullptr;
+    PFNGLDELETEBUFFERSPROC           deleteBuffers           = nullptr;
+    PFNGLBINDBUFFERPROC              bindBuffer              = nullptr;
+    PFNGLBUFFERDATAPROC              bufferData              = nullptr;
+    PFNGLBUFFERSUBDATAPROC           bufferSubData           = nullptr;
+    PFNGLVERTEXATTRIBPOINTERPROC     vertexAttribPointer     = nullptr;
+    PFNGLENABLEVERTEXATTRIBARRAYPROC enableVertexAttribArray = nullptr;
+    PFNGLBLENDEQUATIONPROC           blendEquation           = nullptr;
+    PFNGLBLENDFUNCSEPARATEPROC       blendFuncSeparate       = nullptr;
+    PFNGLACTIVETEXTUREPROC           activeTexture           = nullptr;
+
+    // optional - vertex array objects (GL 3 / WebGL 2) and persistent mapping (GL_ARB_buffer_storage)
+    PFNGLGENVERTEXARRAYSPROC    genVertexArrays    = nullptr;
+    PFNGLDELETEVERTEXARRAYSPROC deleteVertexArrays = nullptr;
+    PFNGLBINDVERTEXARRAYPROC    bindVertexArray    = nullptr;
+    PFNGLBUFFERSTORAGEPROC      bufferStorage      = nullptr;
+    PFNGLMAPBUFFERRANGEPROC     mapBufferRange     = nullptr;
+    PFNGLUNMAPBUFFERPROC        unmapBuffer        = nullptr;
+    PFNGLFENCESYNCPROC          fenceSync          = nullptr;
+    PFNGLCLIENTWAITSYNCPROC     clientWaitSync     = nullptr;
+    PFNGLDELETESYNCPROC         deleteSync         = nullptr;
+
+    bool load() {
+        genBuffers              = (PFNGLGENBUFFERSPROC)              SDL_GL_GetProcAddress("glGenBuffers");
+        deleteBuffers           = (PFNGLDELETEBUFFERSPROC)           SDL_GL_GetProcAddress("glDeleteBuffers");
+        bindBuffer              = (PFNGLBINDBUFFERPROC)              SDL_GL_GetProcAddress("glBindBuffer");
+        bufferData              = (PFNGLBUFFERDATAPROC)              SDL_GL_GetProcAddress("glBufferData");
+        bufferSubData           = (PFNGLBUFFERSUBDATAPROC)           SDL_GL_GetProcAddress("glBufferSubData");
+        vertexAttribPointer     = (PFNGLVERTEXATTRIBPOINTERPROC)     SDL_GL_GetProcAddress("glVertexAttribPointer");
+        enableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC) SDL_GL_GetProcAddress("glEnableVertexAttribArray");
+        blendEquation           = (PFNGLBLENDEQUATIONPROC)           SDL_GL_GetProcAddress("glBlendEquation");
+        blendFuncSeparate       = (PFNGLBLENDFUNCSEPARATEPROC)       SDL_GL_GetProcAddress("glBlendFuncSeparate");
+        activeTexture           = (PFNGLACTIVETEXTUREPROC)           SDL_GL_GetProcAddress("glActiveTexture");
+
+        if (isLegacyGlsl() == false) {
+            genVertexArrays    = (PFNGLGENVERTEXARRAYSPROC)    SDL_GL_GetProcAddress("glGenVertexArrays");
+            deleteVertexArrays = (PFNGLDELETEVERTEXARRAYSPROC) SDL_GL_GetProcAddress("glDeleteVertexArrays");
+            bindVertexArray    = (PFNGLBINDVERTEXARRAYPROC)    SDL_GL_GetProcAddress("glBindVertexArray");
+        }
+
+#ifndef __EMSCRIPTEN__
+        if (SDL_GL_ExtensionSupported("GL_ARB_buffer_storage")) {
+            bufferStorage  = (PFNGLBUFFERSTORAGEPROC)  SDL_GL_GetProcAddress("glBufferStorage");
+            mapBufferRange = (PFNGLMAPBUFFERRANGEPROC) SDL_GL_GetProcAddress("glMapBufferRange");
+            unmapBuffer    = (PFNGLUNMAPBUFFERPROC)    SDL_GL_GetProcAddress("glUnmapBuffer");
+            fenceSync      = (PFNGLFENCESYNCPROC)      SDL_GL_GetProcAddress("glFenceSync");
+            clientWaitSync = (PFNGLCLIENTWAITSYNCPROC) SDL_GL_GetProcAddress("glClientWaitSync");
+            deleteSync     = (PFNGLDELETESYNCPROC)     SDL_GL_GetProcAddress("glDeleteSync");
+        }
+#endif
+
+        persistent = bufferStorage && mapBufferRange && unmapBuffer && fenceSync && clientWaitSync && deleteSync;
+
+        return genBuffers && deleteBuffers && bindBuffer && bufferData && bufferSubData && vertexAttribPointer &&
+            enableVertexAttribArray && blendEquation && blendFuncSeparate && activeTexture &&
+            (isLegacyGlsl() || (genVertexArrays && deleteVertexArrays && bindVertexArray));
+    }
+} g_Stream;
+
+size_t alignStream(size_t n) {
+    return (n + kStreamAlign - 1) & ~(kStreamAlign - 1);
+}
+
+// fast hash of the uploaded data - 8 bytes at a time
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*) data;
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        hash = (hash ^ w)*0x9e3779b97f4a7c15ull;
+        hash ^= hash >> 29;
+    }
+
+    for (; i < size; ++i) {
+        hash = (hash ^ p[i])*0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+// wait until the GPU has finished with the last frame that used the rings
+void waitStreamFence() {
+    if (g_Stream.fence == nullptr) {
+        return;
+    }
+
+    while (g_Stream.clientWaitSync(g_Stream.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+
+    g_Stream.deleteSync(g_Stream.fence);
+    g_Stream.fence = nullptr;
+}
+
+void destroyStreamRing(StreamRing& ring) {
+    if (ring.buffer == 0) {
+        return;
+    }
+
+    if (ring.mapped) {
+        g_Stream.bindBuffer(ring.target, ring.buffer);
+        g_Stream.unmapBuffer(ring.target);
+        ring.mapped = nullptr;
+    }
+
+    g_Stream.deleteBuffers(1, &ring.buffer);
+    ring.buffer = 0;
+    ring.capacity = 0;
+    ring.head = 0;
+}
+
+bool createStreamRing(StreamRing& ring, size_t capacity) {
+    destroyStreamRing(ring);
+
+    g_Stream.genBuffers(1, &ring.buffer);
+    g_Stream.bindBuffer(ring.target, ring.buffer);
+
+    if (g_Stream.persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        g_Stream.bufferStorage(ring.target, capacity, nullptr, flags);
+        ring.mapped = (uint8_t*) g_Stream.mapBufferRange(ring.target, 0, capacity, flags);
+        if (ring.mapped == nullptr) {
+            fprintf(stderr, "Error: failed to map a streaming buffer of %zu bytes\n", capacity);
+            return false;
+        }
+    } else {
+        g_Stream.bufferData(ring.target, capacity, nullptr, GL_STREAM_DRAW);
+    }
+
+    ring.capacity = capacity;
+    ring.head = 0;
+
+    return true;
+}
+
+// append the data at the head of the ring - the caller makes sure that it fits
+size_t writeStreamRing(StreamRing& ring, const void* data, size_t size) {
+    const size_t offset = ring.head;
+
+    if (size > 0) {
+        if (ring.mapped) {
+            memcpy(ring.mapped + offset, data, size);
+        } else {
+            g_Stream.bindBuffer(ring.target, ring.buffer);
+            g_Stream.bufferSubData(ring.target, offset, size, data);
+        }
+    }
+
+    ring.head = alignStream(offset + size);
+
+    return offset;
+}
+
+// upper bound of the packed indices of a list, in bytes
+size_t streamIndicesSize(const ImDrawList* list) {
+    // each command can be preceded by 2 bytes of padding for the alignment of the 32-bit indices
+    return list->IdxBuffer.Size*sizeof(ImDrawIdx) + 2*list->CmdBuffer.Size;
+}
+
+// pack the indices of each command as 16-bit if its vertex range fits, and as 32-bit otherwise
+// returns the number of bytes written to dst - the offsets in cached.cmds are relative to dst
+size_t packStreamIndices(const ImDrawList* list, StreamList& cached, uint8_t* dst, int& nCmds16, int& nCmds32) {
+    size_t pos = 0;
+
+    cached.cmds.resize(list->CmdBuffer.Size);
+    for (int i = 0; i < list->CmdBuffer.Size; ++i) {
+        const ImDrawCmd& cmd = list->CmdBuffer[i];
+        StreamCmd& res = cached.cmds[i];
+
+        if (cmd.UserCallback != nullptr || cmd.ElemCount == 0) {
+            res = {};
+            continue;
+        }
+
+        const ImDrawIdx* src = list->IdxBuffer.Data + cmd.IdxOffset;
+
+        // the indices of a list with up to 64K vertices always fit - scan only the huge lists
+        uint32_t idxMin = 0;
+        uint32_t idxMax = 0;
+        if (sizeof(ImDrawIdx) > 2 && list->VtxBuffer.Size > 0x10000) {
+            idxMin = UINT32_MAX;
+            for (unsigned int k = 0; k < cmd.ElemCount; ++k) {
+                idxMin = std::min(idxMin, (uint32_t) src[k]);
+                idxMax = std::max(idxMax, (uint32_t) src[k]);
+            }
+        }
+
+        res.is16 = idxMax - idxMin <= 0xFFFF;
+
+        if (res.is16) {
+            pos = (pos + 1) & ~(size_t) 1;
+            res.idxOffset = pos;
+            res.baseVertex = cmd.VtxOffset + idxMin;
+
+            uint16_t* out = (uint16_t*) (dst + pos);
+            for (unsigned int k = 0; k < cmd.ElemCount; ++k) {
+                out[k] = (uint16_t) (src[k] - idxMin);
+            }
+
+            pos += cmd.ElemCount*sizeof(uint16_t);
+            ++nCmds16;
+        } else {
+            pos = (pos + 3) & ~(size_t) 3;
+            res.idxOffset = pos;
+            res.baseVertex = cmd.VtxOffset; // the indices are copied as they are
+
+            memcpy(dst + pos, src, cmd.ElemCount*sizeof(uint32_t));
+
+            pos += cmd.ElemCount*sizeof(uint32_t);
+            ++nCmds32;
+        }
+    }
+
+    return pos;
+}
+
+bool initStream() {
+    if (g_Stream.load() == false || g_SDF.load() == false) {
+        fprintf(stderr, "Warning: streaming renderer is not supported - using the stock renderer\n");
+        return false;
+    }
+
+    const GLint locations[3] = { kAttribPosition, kAttribUV, kAttribColor, };
+
+    g_Stream.program = createProgram(isLegacyGlsl() ? kVertexShader_100 : kVertexShader_130,
+                                     isLegacyGlsl() ? kFragmentShader_100 : kFragmentShader_130, locations);
+    if (g_Stream.program == 0) {
+        return false;
+    }
+
+    g_Stream.locTexture = g_SDF.getUniformLocation(g_Stream.program, "Texture");
+    g_Stream.locProjMtx = g_SDF.getUniformLocation(g_Stream.program, "ProjMtx");
+
+    // without the SDF program, the text is drawn with the regular one - blurry, but still readable
+    g_Stream.programSDF = createProgram(isLegacyGlsl() ? kVertexShader_100 : kVertexShader_130,
+                                        isLegacyGlsl() ? kSDFFragmentShader_100 : kSDFFragmentShader_130, locations);
+    if (g_Stream.programSDF) {
+        g_Stream.locTextureSDF = g_SDF.getUniformLocation(g_Stream.programSDF, "Texture");
+        g_Stream.locProjMtxSDF = g_SDF.getUniformLocation(g_Stream.programSDF, "ProjMtx");
+    }
+
+    if (g_Stream.genVertexArrays) {
+        g_Stream.genVertexArrays(1, &g_Stream.vao);
+    }
+
+    g_Stream.vtx.target = GL_ARRAY_BUFFER;
+    g_Stream.idx.target = GL_ELEMENT_ARRAY_BUFFER;
+
+    printf("Streaming renderer: %s\n", g_Stream.persistent ? "persistently mapped buffers" : "buffer sub-data with orphaning");
+
+    return true;
+}
+
+void deinitStream() {
+    if (g_Stream.initialized == false) {
+        return;
+    }
+
+    if (g_Stream.persistent) {
+        waitStreamFence();
+    }
+
+    destroyStreamRing(g_Stream.vtx);
+    destroyStreamRing(g_Stream.idx);
+
+    if (g_Stream.vao) {
+        g_Stream.deleteVertexArrays(1, &g_Stream.vao);
+        g_Stream.vao = 0;
+    }
+
+    if (g_Stream.program) {
+        g_SDF.deleteProgram(g_Stream.program);
+        g_Stream.program = 0;
+    }
+
+    if (g_Stream.programSDF) {
+        g_SDF.deleteProgram(g_Stream.programSDF);
+        g_Stream.programSDF = 0;
+    }
+
+    g_Stream.lists.clear();
+    g_Stream.initialized = false;
+}
+
+void setStreamVertexOffset(size_t offset) {
+    g_Stream.vertexAttribPointer(kAttribPosition, 2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (const void*) (offset + offsetof(ImDrawVert, pos)));
+    g_Stream.vertexAttribPointer(kAttribUV,       2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (const void*) (offset + offsetof(ImDrawVert, uv)));
+    g_Stream.vertexAttribPointer(kAttribColor,    4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (const void*) (offset + offsetof(ImDrawVert, col)));
+}
+
+void setupStreamRenderState(ImDrawData* draw_data, int fb_width, int fb_height) {
+    glEnable(GL_BLEND);
+    g_Stream.blendEquation(GL_FUNC_ADD);
+    g_Stream.blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_STENCIL_TEST);
+    glEnable(GL_SCISSOR_TEST);
+
+    glViewport(0, 0, (GLsizei) fb_width, (GLsizei) fb_height);
+
+    float ortho[4][4];
+    getProjection(draw_data, ortho);
+
+    g_SDF.useProgram(g_Stream.program);
+    g_SDF.uniform1i(g_Stream.locTexture, 0);
+    g_SDF.uniformMatrix4fv(g_Stream.locProjMtx, 1, GL_FALSE, &ortho[0][0]);
+
+    if (g_Stream.programSDF) {
+        g_SDF.useProgram(g_Stream.programSDF);
+        g_SDF.uniform1i(g_Stream.locTextureSDF, 0);
+        g_SDF.uniformMatrix4fv(g_Stream.locProjMtxSDF, 1, GL_FALSE, &ortho[0][0]);
+    }
+
+    g_Stream.activeTexture(GL_TEXTURE0);
+
+    if (g_Stream.vao) {
+        g_Stream.bindVertexArray(g_Stream.vao);
+    }
+
+    g_Stream.bindBuffer(GL_ARRAY_BUFFER,         g_Stream.vtx.buffer);
+    g_Stream.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_Stream.idx.buffer);
+
+    g_Stream.enableVertexAttribArray(kAttribPosition);
+    g_Stream.enableVertexAttribArray(kAttribUV);
+    g_Stream.enableVertexAttribArray(kAttribColor);
+}
+
+// upload the changed lists - returns false if the rings could not be (re)created
+bool uploadStream(ImDrawData* draw_data) {
+    auto& st = g_Stream;
+
+    const int n = draw_data->CmdListsCount;
+
+    size_t vtxTotal = 0;
+    size_t idxTotal = 0;
+    for (int i = 0; i < n; ++i) {
+        vtxTotal += alignStream(draw_data->CmdLists[i]->VtxBuffer.Size*sizeof(ImDrawVert));
+        idxTotal += alignStream(streamIndicesSize(draw_data->CmdLists[i]));
+    }
+
+    // grow the rings - the old data is lost
+    if (st.vtx.buffer == 0 || vtxTotal*kStreamFrames > st.vtx.capacity || idxTotal*kStreamFrames > st.idx.capacity) {
+        if (st.persistent) {
+            waitStreamFence();
+        }
+
+        size_t vtxCapacity = std::max(kStreamMinSize, st.vtx.capacity);
+        size_t idxCapacity = std::max(kStreamMinSize, st.idx.capacity);
+        while (vtxCapacity < vtxTotal*kStreamFrames) vtxCapacity *= 2;
+        while (idxCapacity < idxTotal*kStreamFrames) idxCapacity *= 2;
+
+        if (createStreamRing(st.vtx, vtxCapacity) == false || createStreamRing(st.idx, idxCapacity) == false) {
+            return false;
+        }
+
+        ++st.generation;
+    }
+
+    // not enough space until the end of the rings - start from the beginning, discarding the old data
+    if (st.vtx.head + vtxTotal > st.vtx.capacity || st.idx.head + idxTotal > st.idx.capacity) {
+        if (st.persistent) {
+            waitStreamFence();
+        } else {
+            st.bindBuffer(st.vtx.target, st.vtx.buffer);
+            st.bufferData(st.vtx.target, st.vtx.capacity, nullptr, GL_STREAM_DRAW);
+            st.bindBuffer(st.idx.target, st.idx.buffer);
+            st.bufferData(st.idx.target, st.idx.capacity, nullptr, GL_STREAM_DRAW);
+        }
+
+        st.vtx.head = 0;
+        st.idx.head = 0;
+
+        ++st.generation;
+    }
+
+    int nUploaded = 0;
+    int nSkipped = 0;
+    int64_t nBytes = 0;
+    int nCmds16 = 0;
+    int nCmds32 = 0;
+
+    st.lists.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const ImDrawList* list = draw_data->CmdLists[i];
+        StreamList& cached = st.lists[i];
+
+        const size_t vtxSize = list->VtxBuffer.Size*sizeof(ImDrawVert);
+        const size_t idxSize = list->IdxBuffer.Size*sizeof(ImDrawIdx);
+
+        uint64_t hash = 0xcbf29ce484222325ull;
+        hash = hashBytes(hash, list->VtxBuffer.Data, vtxSize);
+        hash = hashBytes(hash, list->IdxBuffer.Data, idxSize);
+
+        // the packing depends on how the indices are split into commands
+        for (const ImDrawCmd& cmd : list->CmdBuffer) {
+            const uint32_t range[3] = { cmd.VtxOffset, cmd.IdxOffset, cmd.ElemCount, };
+            hash = hashBytes(hash, range, sizeof(range));
+        }
+
+        if (cached.generation == st.generation && cached.hash == hash &&
+            cached.nVtx == list->VtxBuffer.Size && cached.nIdx == list->IdxBuffer.Size) {
+            ++nSkipped;
+            continue;
+        }
+
+        cached.hash = hash;
+        cached.generation = st.generation;
+        cached.nVtx = list->VtxBuffer.Size;
+        cached.nIdx = list->IdxBuffer.Size;
+        cached.vtxOffset = writeStreamRing(st.vtx, list->VtxBuffer.Data, vtxSize);
+
+        // pack the indices directly into the mapped ring
+        size_t idxOffset = 0;
+        size_t idxPacked = 0;
+        if (st.idx.mapped) {
+            idxOffset = st.idx.head;
+            idxPacked = packStreamIndices(list, cached, st.idx.mapped + idxOffset, nCmds16, nCmds32);
+            st.idx.head = alignStream(idxOffset + idxPacked);
+        } else {
+            st.scratch.resize(streamIndicesSize(list));
+            idxPacked = packStreamIndices(list, cached, st.scratch.data(), nCmds16, nCmds32);
+            idxOffset = writeStreamRing(st.idx, st.scratch.data(), idxPacked);
+        }
+
+        for (auto& cmd : cached.cmds) {
+            cmd.idxOffset += idxOffset;
+        }
+
+        ++nUploaded;
+        nBytes += vtxSize + idxPacked;
+    }
+
+    st.nListsUploaded = nUploaded;
+    st.nListsSkipped = nSkipped;
+    st.nBytesUploaded = nBytes;
+    st.nCmdsIdx16 = nCmds16;
+    st.nCmdsIdx32 = nCmds32;
+
+    return true;
+}
+
+bool renderStream(ImDrawData* draw_data) {
+    auto& st = g_Stream;
+
+    if (st.initialized == false) {
+        if (st.failed) {
+            return false;
+        }
+
+        st.initialized = initStream();
+        if (st.initialized == false) {
+            st.failed = true;
+            deinitStream();
+            return false;
+        }
+    }
+
+    const int fb_width  = (int) (draw_data->DisplaySize.x*draw_data->FramebufferScale.x);
+    const int fb_height = (int) (draw_data->DisplaySize.y*draw_data->FramebufferScale.y);
+    if (fb_width <= 0 || fb_height <= 0) {
+        return true;
+    }
+
+    if (uploadStream(draw_data) == false) {
+        st.failed = true;
+        deinitStream();
+        return false;
+    }
+
+    setupStreamRenderState(draw_data, fb_width, fb_height);
+
+    const ImTextureID texFont = ImGui::GetIO().Fonts->TexID;
+
+    const ImVec2 clip_off   = draw_data->DisplayPos;
+    const ImVec2 clip_scale = draw_data->FramebufferScale;
+
+    // the state that is already set - the redundant changes are skipped
+    GLuint programCur = 0;
+    GLuint texCur = 0;
+    GLint scissorCur[4] = { -1, -1, -1, -1, };
+
+    int nDrawCalls = 0;
+    int nStateChanges = 0;
+
+    for (int n = 0; n < draw_data->CmdListsCount; ++n) {
+        const ImDrawList* list = draw_data->CmdLists[n];
+        const StreamList& cached = st.lists[n];
+
+        size_t vtxOffsetCur = (size_t) -1;
+
+        for (int i = 0; i < list->CmdBuffer.Size; ++i) {
+            const ImDrawCmd& cmd = list->CmdBuffer[i];
+            const StreamCmd& packed = cached.cmds[i];
+
+            if (cmd.UserCallback != nullptr) {
+                if (cmd.UserCallback == ImDrawCallback_ResetRenderState) {
+                    setupStreamRenderState(draw_data, fb_width, fb_height);
+                } else {
+                    cmd.UserCallback(list, &cmd);
+                }
+
+                programCur = 0;
+                texCur = 0;
+                scissorCur[0] = -1;
+                vtxOffsetCur = (size_t) -1;
+                continue;
+            }
+
+            const ImVec2 clip_min((cmd.ClipRect.x - clip_off.x)*clip_scale.x, (cmd.ClipRect.y - clip_off.y)*clip_scale.y);
+            const ImVec2 clip_max((cmd.ClipRect.z - clip_off.x)*clip_scale.x, (cmd.ClipRect.w - clip_off.y)*clip_scale.y);
+            if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y || cmd.ElemCount == 0) {
+                continue;
+            }
+
+            const bool isSDF = g_SDF.enabled && st.programSDF && cmd.GetTexID() == texFont;
+            const GLuint program = isSDF ? st.programSDF : st.program;
+            if (program != programCur) {
+                g_SDF.useProgram(program);
+                programCur = program;
+                ++nStateChanges;
+            }
+
+            // instead of glDrawElementsBaseVertex(), which is not available in WebGL
+            const size_t vtxOffset = cached.vtxOffset + packed.baseVertex*sizeof(ImDrawVert);
+            if (vtxOffset != vtxOffsetCur) {
+                setStreamVertexOffset(vtxOffset);
+                vtxOffsetCur = vtxOffset;
+                ++nStateChanges;
+            }
+
+            const GLint scissor[4] = {
+                (GLint) clip_min.x, (GLint) ((float) fb_height - clip_max.y), (GLint) (clip_max.x - clip_min.x), (GLint) (clip_max.y - clip_min.y),
+            };
+            if (memcmp(scissor, scissorCur, sizeof(scissor)) != 0) {
+                glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+                memcpy(scissorCur, scissor, sizeof(scissor));
+                ++nStateChanges;
+            }
+
+            const GLuint tex = (GLuint) (intptr_t) cmd.GetTexID();
+            if (tex != texCur) {
+                glBindTexture(GL_TEXTURE_2D, tex);
+                texCur = tex;
+                ++nStateChanges;
+            }
+
+            glDrawElements(GL_TRIANGLES, (GLsizei) cmd.ElemCount, packed.is16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const void*) packed.idxOffset);
+            ++nDrawCalls;
+        }
+    }
+
+    g_Batch.nDrawCalls = nDrawCalls;
+    g_Batch.nStateChanges = nStateChanges;
+
+    // glClear() is affected by the scissor test
+    glDisable(GL_SCISSOR_TEST);
+
+    if (st.vao) {
+        st.bindVertexArray(0);
+    }
+    g_SDF.useProgram(0);
+
+    if (st.persistent) {
+        if (st.fence) {
+            st.deleteSync(st.fence);
+        }
+        st.fence = st.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    return true;
+}
+
+}
 
 bool ImGui_PreInit() {
     // Decide GL+GLSL versions
@@ -54,8 +1151,11 @@ ImGuiContext* ImGui_Init(SDL_Window* window, SDL_GLContext gl_context) {
     const char* glsl_version = "#version 130";
 #endif
 
+    g_GlslVersion = glsl_version;
+
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
+    ImGui_InstallAllocator();
     auto ctx = ImGui::CreateContext();
     ImGui::SetCurrentContext(ctx);
 
@@ -71,11 +1171,94 @@ ImGuiContext* ImGui_Init(SDL_Window* window, SDL_GLContext gl_context) {
     return res ? ctx : nullptr;
 }
 
-void ImGui_Shutdown() { ImGui_ImplOpenGL3_Shutdown(); ImGui_ImplSDL2_Shutdown(); }
+void ImGui_Shutdown() {
+    deinitStream();
+
+    if (g_SDF.program) {
+        g_SDF.deleteProgram(g_SDF.program);
+        g_SDF.program = 0;
+    }
+
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplSDL2_Shutdown();
+}
+
 void ImGui_NewFrame(SDL_Window* window) { ImGui_ImplOpenGL3_NewFrame(); ImGui_ImplSDL2_NewFrame(window); }
 bool ImGui_ProcessEvent(const SDL_Event* event) { return ImGui_ImplSDL2_ProcessEvent(event); }
 
-void ImGui_RenderDrawData(ImDrawData* draw_data)    { ImGui_ImplOpenGL3_RenderDrawData(draw_data); }
+void ImGui_RenderDrawData(ImDrawData* draw_data) {
+    batchDrawData(draw_data);
+
+    if (renderStream(draw_data)) {
+        return;
+    }
+
+    if (g_SDF.enabled) {
+        g_SDF.drawData = draw_data;
+        patchDrawData(draw_data);
+    }
+
+    // the stock renderer sets the full state for each command
+    g_Batch.nStateChanges = -1;
+
+    ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+}
+
+void ImGui_SetFontSDF(bool enable)  { g_SDF.enabled = enable; }
+
+ImGuiRenderStats ImGui_GetRenderStats() {
+    ImGuiRenderStats res;
+
+    res.isStreaming    = g_Stream.initialized;
+    res.isPersistent   = g_Stream.initialized && g_Stream.persistent;
+    res.nListsUploaded = g_Stream.nListsUploaded;
+    res.nListsSkipped  = g_Stream.nListsSkipped;
+    res.nBytesUploaded = g_Stream.nBytesUploaded;
+    res.nCmdsIdx16     = g_Stream.nCmdsIdx16;
+    res.nCmdsIdx32     = g_Stream.nCmdsIdx32;
+    res.nCmds          = g_Batch.nCmds;
+    res.nDrawCalls     = g_Batch.nDrawCalls;
+    res.nStateChanges  = g_Batch.nStateChanges;
+
+    return res;
+}
+
+int ImGui_GetRenderCmdCapacity(int nCmds) {
+    // a program switch before each command and one after the last
+    return 2*nCmds + 1;
+}
+
+bool ImGui_CheckStreamIndices(const ImDrawList* list) {
+    StreamList cached;
+    std::vector<uint8_t> packed(streamIndicesSize(list));
+
+    int nCmds16 = 0;
+    int nCmds32 = 0;
+    packStreamIndices(list, cached, packed.data(), nCmds16, nCmds32);
+
+    for (int i = 0; i < list->CmdBuffer.Size; ++i) {
+        const ImDrawCmd& cmd = list->CmdBuffer[i];
+        const StreamCmd& res = cached.cmds[i];
+
+        if (cmd.UserCallback != nullptr || cmd.ElemCount == 0) {
+            continue;
+        }
+
+        const ImDrawIdx* src = list->IdxBuffer.Data + cmd.IdxOffset;
+        for (unsigned int k = 0; k < cmd.ElemCount; ++k) {
+            const uint32_t idx = res.is16 ?
+                ((const uint16_t*) (packed.data() + res.idxOffset))[k] :
+                ((const uint32_t*) (packed.data() + res.idxOffset))[k];
+
+            // the vertex that the renderer reads must be the one the command refers to
+            if (res.baseVertex + idx != cmd.VtxOffset + (uint32_t) src[k]) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
 
 bool ImGui_CreateFontsTexture()     { return ImGui_ImplOpenGL3_CreateFontsTexture(); }
 void ImGui_DestroyFontsTexture()    { ImGui_ImplOpenGL3_DestroyFontsTexture(); }
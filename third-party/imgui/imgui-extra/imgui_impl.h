@@ -23,6 +23,40 @@ bool IMGUI_API ImGui_ProcessEvent(const SDL_Event* event);
 
 void IMGUI_API ImGui_RenderDrawData(ImDrawData* draw_data);
 
+// ImGui_RenderDrawData() modifies the command buffers of the lists - it does not allocate if their capacity is at least
+// this, given the number of commands
+int IMGUI_API ImGui_GetRenderCmdCapacity(int nCmds);
+
+// render the font texture as a signed distance field (the alpha channel stores the distance to the glyph edge)
+// a separate shader is used for the draw commands that sample the font texture
+void IMGUI_API ImGui_SetFontSDF(bool enable);
+
+// the draw data is streamed into persistently mapped ring buffers natively, or with glBufferSubData() on WebGL,
+// and the lists that did not change since the last frame are not uploaded again
+// the indices of each draw command are uploaded as 16-bit, unless its vertex range does not fit
+// the adjacent draw commands with the same state are merged before rendering, and the redundant state changes are skipped
+struct ImGuiRenderStats {
+    bool isStreaming    = false; // false - the stock renderer is used
+    bool isPersistent   = false;
+
+    // last frame
+    int nListsUploaded  = 0;
+    int nListsSkipped   = 0;
+    long long nBytesUploaded = 0;
+    int nCmdsIdx16      = 0; // draw commands with their indices packed as 16-bit
+    int nCmdsIdx32      = 0;
+    int nCmds           = 0; // draw commands before batching
+    int nDrawCalls      = 0;
+    int nStateChanges   = 0; // program, texture, scissor and vertex buffer changes - -1 with the stock renderer
+};
+
+// can be called from any thread
+ImGuiRenderStats IMGUI_API ImGui_GetRenderStats();
+
+// for testing - packs the indices of the list as they would be uploaded, and checks that each packed index with the
+// base vertex of its command addresses the same vertex as the original index
+bool IMGUI_API ImGui_CheckStreamIndices(const ImDrawList* list);
+
 bool IMGUI_API ImGui_CreateFontsTexture();
 void IMGUI_API ImGui_DestroyFontsTexture();
 bool IMGUI_API ImGui_CreateDeviceObjects();